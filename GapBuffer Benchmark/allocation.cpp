@@ -0,0 +1,73 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//Buffers count and the text length of every buffer: small ones fit inline
+static void ChurnSizes(benchmark::internal::Benchmark* b) {
+	b->Args({ 200000, 16 })->Args({ 200000, 256 })->Unit(benchmark::kMillisecond);
+}
+
+//Create, fill and destroy the buffers, like the editor opening many small documents
+template <class Buffer, class Container>
+static void Churn(Container& buffers, const string& text, const size_t& count) {
+	for (size_t i = 0; i < count; ++i) {
+		buffers.emplace_back();
+		buffers.back().Insert(0, begin(text), end(text));
+		buffers.back().Insert(text.size() / 2, 'x');
+	}
+	benchmark::DoNotOptimize(buffers.data());
+	buffers.clear();
+}
+
+static void BM_ChurnDefaultAllocator(benchmark::State& state) {
+	const string text(state.range(1), 'a');
+	vector<GapBuffer> buffers;
+	buffers.reserve(state.range(0));
+	for (auto _ : state)
+		Churn<GapBuffer>(buffers, text, state.range(0));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnDefaultAllocator)->Apply(ChurnSizes);
+
+//All buffers are released at once by the arena reset
+static void BM_ChurnMonotonicArena(benchmark::State& state) {
+	const string text(state.range(1), 'a');
+	vector<char> arena_storage(state.range(0) * (state.range(1) * 4 + 64));
+	for (auto _ : state) {
+		pmr::monotonic_buffer_resource arena(arena_storage.data(), arena_storage.size());
+		pmr::vector<PmrGapBuffer> buffers(&arena);
+		buffers.reserve(state.range(0));
+		Churn<PmrGapBuffer>(buffers, text, state.range(0));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnMonotonicArena)->Apply(ChurnSizes);
+
+static void BM_ChurnPool(benchmark::State& state) {
+	const string text(state.range(1), 'a');
+	pmr::unsynchronized_pool_resource pool;
+	pmr::vector<PmrGapBuffer> buffers(&pool);
+	buffers.reserve(state.range(0));
+	for (auto _ : state)
+		Churn<PmrGapBuffer>(buffers, text, state.range(0));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnPool)->Apply(ChurnSizes);
+
+//Clear keeps small buffers inline, the storage isn't allocated again
+static void BM_ClearSmall(benchmark::State& state) {
+	const string text(16, 'a');
+	GapBuffer gp;
+	for (auto _ : state) {
+		gp.Insert(0, begin(text), end(text));
+		gp.Clear();
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_ClearSmall);
@@ -0,0 +1,57 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//Carets spread evenly through the file, every caret replaces 2 chars by 3
+static vector<GapBuffer::edit> MakeEdits(const size_t& size, const size_t& carets, const string& text) {
+	vector<GapBuffer::edit> edits;
+	for (size_t i = 0; i < carets; ++i)
+		edits.push_back({ size / carets * i, 2, text });
+	return edits;
+}
+
+//File of 10 MB with 1k and 10k carets
+static void CaretCounts(benchmark::internal::Benchmark* b) {
+	b->Args({ 10 << 20, 1'000 })->Args({ 10 << 20, 10'000 })->ArgNames({ "bytes", "carets" })->Unit(benchmark::kMillisecond);
+}
+
+static void BM_BatchEdit(benchmark::State& state) {
+	const string text = "abc";
+	const auto edits = MakeEdits(state.range(0), state.range(1), text);
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, state.range(0), 'x');
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(gp.BatchEdit(edits));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_BatchEdit)->Apply(CaretCounts);
+
+//Every edit moves the gap to its caret, the offsets are shifted by the previous edits
+static void BM_EditPerCaret(benchmark::State& state) {
+	const string text = "abc";
+	const auto edits = MakeEdits(state.range(0), state.range(1), text);
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, state.range(0), 'x');
+		gp.Insert(0, 'x');
+		state.ResumeTiming();
+		size_t shift = 0;
+		for (const auto& change : edits) {
+			gp.Erase(cbegin(gp) + change.offset + shift, cbegin(gp) + change.offset + shift + change.erase_count);
+			gp.Insert(change.offset + shift, change.text);
+			shift += change.text.size() - change.erase_count;
+		}
+		benchmark::DoNotOptimize(gp.Size());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_EditPerCaret)->Apply(CaretCounts);
@@ -0,0 +1,63 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/ChunkedGapBuffer.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace std;
+
+//Document sizes: 64 MB and 1 GB
+static void DocumentSizes(benchmark::internal::Benchmark* b) {
+	b->Arg(64 << 20)->Arg(int64_t(1) << 30)->Unit(benchmark::kMicrosecond);
+}
+
+//Every edit is at a random position, an insert of the char is followed by the erase of one,
+//so the size stays the same. The flat buffer moves the gap by the half of the data in average.
+template <class Buffer>
+static void BM_RandomEdits(benchmark::State& state) {
+	Buffer gp;
+	gp.Insert(0, state.range(0), 'x');
+	mt19937_64 random(42);
+	for (auto _ : state) {
+		const size_t index = random() % gp.Size();
+		gp.Insert(index, 'y');
+		const size_t erased = random() % gp.Size();
+		gp.Erase(cbegin(gp) + erased);
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_RandomEdits<GapBuffer>)->Apply(DocumentSizes);
+BENCHMARK(BM_RandomEdits<ChunkedGapBuffer>)->Apply(DocumentSizes);
+
+//Access to random elements, the chunked buffer finds the leaf in the Fenwick tree
+template <class Buffer>
+static void BM_RandomAccess(benchmark::State& state) {
+	Buffer gp;
+	gp.Insert(0, state.range(0), 'x');
+	gp.Insert(gp.Size() / 2, 'y');
+	mt19937_64 random(42);
+	const Buffer& view = gp;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(*(cbegin(view) + random() % view.Size()));
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RandomAccess<GapBuffer>)->Apply(DocumentSizes);
+BENCHMARK(BM_RandomAccess<ChunkedGapBuffer>)->Apply(DocumentSizes);
+
+//Full pass through the iterators
+template <class Buffer>
+static void BM_Iterate(benchmark::State& state) {
+	Buffer gp;
+	gp.Insert(0, state.range(0), 'x');
+	gp.Insert(gp.Size() / 2, 'y');
+	for (auto _ : state) {
+		size_t count = 0;
+		for (auto it = cbegin(gp); it != cend(gp); ++it)
+			count += *it == 'y';
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetBytesProcessed(state.iterations() * gp.Size());
+}
+BENCHMARK(BM_Iterate<GapBuffer>)->Apply(DocumentSizes);
+BENCHMARK(BM_Iterate<ChunkedGapBuffer>)->Apply(DocumentSizes);
@@ -0,0 +1,48 @@
+#include "../GapBuffer/ConcurrentGapBuffer.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+using namespace std;
+
+constexpr size_t document_size = 64 << 20;
+constexpr size_t read_size = 4 << 10;
+
+static ConcurrentGapBuffer& Document() {
+	static ConcurrentGapBuffer gp;
+	static const bool filled = [] {
+		gp.Edit([](ChunkedGapBuffer& data) { data.Insert(0, document_size, 'x'); });
+		return true;
+	}();
+	(void)filled;
+	return gp;
+}
+
+//The thread 0 is the writer which types and removes the typed elements all the time,
+//the other threads read 4 KB at random positions of the last published snapshot.
+//Reads per second should grow with the count of the reader threads.
+static void BM_ReadersUnderEdits(benchmark::State& state) {
+	ConcurrentGapBuffer& gp = Document();
+	mt19937_64 random(state.thread_index());
+	size_t reads = 0;
+	for (auto _ : state) {
+		if (state.thread_index() == 0) {
+			const size_t index = random() % document_size;
+			gp.Insert(index, 'y');
+			gp.Erase(index, 1);
+			continue;
+		}
+
+		const auto view = gp.Read();
+		const size_t index = random() % (view->Size() - read_size);
+		size_t count = 0;
+		auto it = cbegin(*view) + index;
+		for (size_t i = 0; i < read_size; ++i, ++it)
+			count += *it == 'y';
+		benchmark::DoNotOptimize(count);
+		++reads;
+	}
+	if (state.thread_index() != 0)
+		state.SetBytesProcessed(static_cast<int64_t>(reads * read_size));
+}
+BENCHMARK(BM_ReadersUnderEdits)->ThreadRange(2, 64)->UseRealTime();
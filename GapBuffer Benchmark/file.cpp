@@ -0,0 +1,78 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+//The log file of the size in the temporary directory, it's written once and removed at exit
+static const filesystem::path& LogFile(const size_t& size) {
+	struct file {
+		filesystem::path path;
+		~file() { filesystem::remove(path); }
+	};
+	static file log{ filesystem::temp_directory_path() / "gapbuffer_benchmark.log" };
+	static size_t written = 0;
+	if (written != size) {
+		ofstream out(log.path, ios::binary | ios::trunc);
+		const string line = "2024-01-01 00:00:00 INFO request served in 12 ms\n";
+		for (size_t i = 0; i < size; i += line.size())
+			out.write(line.data(), min(line.size(), size - i));
+		written = size;
+	}
+	return log.path;
+}
+
+//File sizes: 1 MB, 256 MB and 2 GB
+static void FileSizes(benchmark::internal::Benchmark* b) {
+	b->Arg(1 << 20)->Arg(256 << 20)->Arg(int64_t(2) << 30)->Unit(benchmark::kMillisecond);
+}
+
+//Opening maps the file, nothing is read
+static void BM_FromFile(benchmark::State& state) {
+	const auto& path = LogFile(state.range(0));
+	for (auto _ : state) {
+		GapBuffer gp = GapBuffer::FromFile(path);
+		benchmark::DoNotOptimize(gp.Size());
+	}
+}
+BENCHMARK(BM_FromFile)->Apply(FileSizes);
+
+//Opening and reading every byte through the mapping
+static void BM_FromFileCount(benchmark::State& state) {
+	const auto& path = LogFile(state.range(0));
+	for (auto _ : state) {
+		GapBuffer gp = GapBuffer::FromFile(path);
+		benchmark::DoNotOptimize(gp.Count('\n'));
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FromFileCount)->Apply(FileSizes);
+
+//The first edit copies the file to the own storage
+static void BM_FromFileFirstEdit(benchmark::State& state) {
+	const auto& path = LogFile(state.range(0));
+	for (auto _ : state) {
+		GapBuffer gp = GapBuffer::FromFile(path);
+		gp.Insert(gp.Size() / 2, 'x');
+		benchmark::DoNotOptimize(gp.Size());
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FromFileFirstEdit)->Apply(FileSizes);
+
+//Loading by the stream iterators, as it was done before the mapping
+static void BM_ReadStream(benchmark::State& state) {
+	const auto& path = LogFile(state.range(0));
+	for (auto _ : state) {
+		ifstream in(path, ios::binary);
+		GapBuffer gp{ istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+		benchmark::DoNotOptimize(gp.Size());
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReadStream)->Arg(1 << 20)->Arg(256 << 20)->Unit(benchmark::kMillisecond);
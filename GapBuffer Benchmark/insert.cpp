@@ -0,0 +1,93 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace std;
+
+//Paste sizes: 1 KB, 1 MB and 100 MB
+static void PasteSizes(benchmark::internal::Benchmark* b) {
+	b->Arg(1 << 10)->Arg(1 << 20)->Arg(100 << 20)->Unit(benchmark::kMillisecond);
+}
+
+//The per-char loop used by setNewData and the bug tracking driver
+static void BM_PastePerChar(benchmark::State& state) {
+	const string paste(state.range(0), 'x');
+	for (auto _ : state) {
+		GapBuffer gp;
+		for (string::size_type i = 0; i < paste.size(); ++i)
+			gp.Insert(i, paste[i]);
+		benchmark::DoNotOptimize(gp);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PastePerChar)->Apply(PasteSizes);
+
+static void BM_PasteStringView(benchmark::State& state) {
+	const string paste(state.range(0), 'x');
+	for (auto _ : state) {
+		GapBuffer gp;
+		gp.Insert(0, string_view(paste));
+		benchmark::DoNotOptimize(gp);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PasteStringView)->Apply(PasteSizes);
+
+static void BM_PasteIteratorRange(benchmark::State& state) {
+	const string paste(state.range(0), 'x');
+	for (auto _ : state) {
+		GapBuffer gp;
+		gp.Insert(0, cbegin(paste), cend(paste));
+		benchmark::DoNotOptimize(gp);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PasteIteratorRange)->Apply(PasteSizes);
+
+static void BM_PasteFill(benchmark::State& state) {
+	for (auto _ : state) {
+		GapBuffer gp;
+		gp.Insert(0, static_cast<GapBuffer::size_type>(state.range(0)), 'x');
+		benchmark::DoNotOptimize(gp);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PasteFill)->Apply(PasteSizes);
+
+//Paste into the middle of an existing document, the gap has to travel once
+static void BM_PasteMiddle(benchmark::State& state) {
+	const string paste(state.range(0), 'x');
+	const string document(1 << 20, 'y');
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, string_view(document));
+		state.ResumeTiming();
+		gp.Insert(document.size() / 2, string_view(paste));
+		benchmark::DoNotOptimize(gp);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PasteMiddle)->Apply(PasteSizes);
+
+//Insert into the middle of a full buffer, the storage has to grow. The data is
+//copied once around the new gap, there is no second move of the gap.
+static void BM_GrowAtCursor(benchmark::State& state) {
+	const GapBuffer::size_type size = state.range(0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, size, 'y');
+		gp.Insert(size / 2, gp.StorageSize() - gp.Size(), 'z');
+		state.ResumeTiming();
+		gp.Insert(size / 2, 'x');
+		benchmark::DoNotOptimize(gp);
+		state.PauseTiming();
+		gp.Clear();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GrowAtCursor)->Arg(1 << 20)->Arg(64 << 20)->Arg(1 << 30)->Unit(benchmark::kMillisecond);
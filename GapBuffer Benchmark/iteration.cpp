@@ -0,0 +1,54 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <numeric>
+
+using namespace std;
+
+//Full walk from begin() to end() with the gap in the middle of the buffer.
+//The reported complexity has to be linear.
+static void BM_FullIteration(benchmark::State& state) {
+	const GapBuffer::size_type size = state.range(0);
+	GapBuffer gp;
+	gp.Insert(0, size, 'x');
+	gp.Insert(size / 2, 'y');
+	const GapBuffer& cgp = gp;
+
+	for (auto _ : state) {
+		size_t sum = 0;
+		for (auto it = cgp.begin(); it != cgp.end(); ++it)
+			sum += *it;
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_FullIteration)->Arg(1 << 20)->Arg(10 << 20)->Arg(40 << 20)->Unit(benchmark::kMillisecond)->Complexity(benchmark::oN);
+
+static void BM_EndCall(benchmark::State& state) {
+	GapBuffer gp;
+	gp.Insert(0, static_cast<GapBuffer::size_type>(state.range(0)), 'x');
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.end());
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_EndCall)->Arg(1 << 10)->Arg(1 << 20)->Arg(10 << 20)->Complexity(benchmark::o1);
+
+//Bulk consumer reading the two segments directly instead of iterating
+static void BM_SegmentsSum(benchmark::State& state) {
+	const GapBuffer::size_type size = state.range(0);
+	GapBuffer gp;
+	gp.Insert(0, size, 'x');
+	gp.Insert(size / 2, 'y');
+
+	for (auto _ : state) {
+		auto [before, after] = gp.Segments();
+		size_t sum = accumulate(begin(before), end(before), size_t(0));
+		sum = accumulate(begin(after), end(after), sum);
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SegmentsSum)->Arg(1 << 20)->Arg(10 << 20)->Arg(40 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,66 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/Kernels.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace std;
+
+//Moved data sizes: 64 B, 4 KB, 1 MB and 64 MB
+static void MoveSizes(benchmark::internal::Benchmark* b) {
+	b->Arg(64)->Arg(4 << 10)->Arg(1 << 20)->Arg(64 << 20);
+}
+
+//Insert at the beginning moves the gap over the whole data to the left, erase at the
+//end moves it back, so every iteration moves the data twice.
+static void BM_GapMove(benchmark::State& state) {
+	const string text(state.range(0), 'x');
+	GapBuffer gp;
+	gp.Insert(0, begin(text), end(text));
+	for (auto _ : state) {
+		gp.Insert(0, 'y');
+		gp.Erase(cend(gp) - 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_GapMove)->Apply(MoveSizes);
+
+//Kernels of every level over the same sizes, the searched byte is absent
+static void BM_FindByte(benchmark::State& state) {
+	const byte_kernels& kernels = ByteKernels(static_cast<simd_level>(state.range(1)));
+	const string text(state.range(0), 'x');
+	for (auto _ : state)
+		benchmark::DoNotOptimize(kernels.find_byte(text.data(), text.data() + text.size(), '\n'));
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_CountNewlines(benchmark::State& state) {
+	const byte_kernels& kernels = ByteKernels(static_cast<simd_level>(state.range(1)));
+	string text(state.range(0), 'x');
+	for (string::size_type i = 0; i < text.size(); i += 80)
+		text[i] = '\n';
+	for (auto _ : state)
+		benchmark::DoNotOptimize(kernels.count_byte(text.data(), text.data() + text.size(), '\n'));
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Mismatch(benchmark::State& state) {
+	const byte_kernels& kernels = ByteKernels(static_cast<simd_level>(state.range(1)));
+	const string lhs(state.range(0), 'x');
+	const string rhs = lhs;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(kernels.mismatch(lhs.data(), rhs.data(), lhs.size()));
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void KernelSizes(benchmark::internal::Benchmark* b) {
+	b->ArgNames({ "bytes", "level" });
+	for (int level : { static_cast<int>(simd_level::portable), static_cast<int>(simd_level::sse2), static_cast<int>(simd_level::avx2) })
+		for (int size : { 64, 4 << 10, 1 << 20, 64 << 20 })
+			b->Args({ size, level });
+}
+BENCHMARK(BM_FindByte)->Apply(KernelSizes);
+BENCHMARK(BM_CountNewlines)->Apply(KernelSizes);
+BENCHMARK(BM_Mismatch)->Apply(KernelSizes);
@@ -0,0 +1,70 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+using namespace std;
+
+constexpr size_t line_count = 10'000'000;
+
+//The file of 10M lines from 0 to 15 characters, the gap is left in the middle
+static GapBuffer MakeFile(bool indexed) {
+	string text;
+	text.reserve(line_count * 8);
+	for (size_t i = 0; i < line_count; ++i) {
+		text.append(i % 16, 'x');
+		text.push_back('\n');
+	}
+	GapBuffer gp;
+	gp.Insert(0, begin(text), end(text));
+	gp.Insert(gp.Size() / 2, 'y');
+	gp.EnableLineIndex(indexed);
+	return gp;
+}
+
+static GapBuffer& File(bool indexed) {
+	static GapBuffer plain = MakeFile(false);
+	static GapBuffer with_index = MakeFile(true);
+	return indexed ? with_index : plain;
+}
+
+static void BM_OffsetOfLine(benchmark::State& state) {
+	const GapBuffer& gp = File(state.range(0));
+	mt19937_64 random(42);
+	uniform_int_distribution<size_t> lines(0, line_count - 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.OffsetOfLine(lines(random)));
+}
+BENCHMARK(BM_OffsetOfLine)->ArgName("indexed")->Arg(0)->Arg(1);
+
+static void BM_LineColOf(benchmark::State& state) {
+	const GapBuffer& gp = File(state.range(0));
+	mt19937_64 random(42);
+	uniform_int_distribution<size_t> offsets(0, gp.Size());
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.LineColOf(offsets(random)));
+}
+BENCHMARK(BM_LineColOf)->ArgName("indexed")->Arg(0)->Arg(1);
+
+//Typing at the cursor, the index is updated by every insert and erase
+static void BM_TypeAtCursor(benchmark::State& state) {
+	GapBuffer& gp = File(state.range(0));
+	const size_t cursor = gp.Size() / 2;
+	for (auto _ : state) {
+		gp.Insert(cursor, '\n');
+		gp.Erase(cbegin(gp) + cursor);
+	}
+}
+BENCHMARK(BM_TypeAtCursor)->ArgName("indexed")->Arg(0)->Arg(1);
+
+static void BM_EnableLineIndex(benchmark::State& state) {
+	GapBuffer& gp = File(false);
+	for (auto _ : state) {
+		gp.EnableLineIndex();
+		gp.EnableLineIndex(false);
+	}
+	state.SetBytesProcessed(state.iterations() * gp.Size());
+}
+BENCHMARK(BM_EnableLineIndex)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,218 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/ChunkedGapBuffer.h"
+#include <benchmark/benchmark.h>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#if __has_include(<ext/rope>)
+#include <ext/rope>
+#define GAPBUFFER_BENCHMARK_ROPE 1
+#endif
+
+//Every editing operation over every container at the sizes from 1 KB to 1 GB. The results
+//are compared between the containers and between the versions of the library:
+//  operations --benchmark_out=new.json --benchmark_out_format=json
+//  compare.py benchmarks old.json new.json
+//compare.py is the tool of Google Benchmark.
+
+using namespace std;
+
+//Containers are used through the same operations
+template <class Container> struct operations;
+
+template <> struct operations<GapBuffer> {
+	static GapBuffer Make(size_t size) { GapBuffer result; result.Insert(0, size, 'x'); return result; }
+	static size_t Size(const GapBuffer& c) { return c.Size(); }
+	static void Insert(GapBuffer& c, size_t index, char item) { c.Insert(index, item); }
+	static void Insert(GapBuffer& c, size_t index, const string& items) { c.Insert(index, items); }
+	static void Erase(GapBuffer& c, size_t index, size_t count) { c.Erase(cbegin(c) + index, cbegin(c) + index + count); }
+	static char At(const GapBuffer& c, size_t index) { return cbegin(c)[index]; }
+};
+
+template <> struct operations<ChunkedGapBuffer> {
+	static ChunkedGapBuffer Make(size_t size) { ChunkedGapBuffer result; result.Insert(0, size, 'x'); return result; }
+	static size_t Size(const ChunkedGapBuffer& c) { return c.Size(); }
+	static void Insert(ChunkedGapBuffer& c, size_t index, char item) { c.Insert(index, item); }
+	static void Insert(ChunkedGapBuffer& c, size_t index, const string& items) { c.Insert(index, items); }
+	static void Erase(ChunkedGapBuffer& c, size_t index, size_t count) { c.Erase(cbegin(c) + index, cbegin(c) + index + count); }
+	static char At(const ChunkedGapBuffer& c, size_t index) { return c[index]; }
+};
+
+template <> struct operations<string> {
+	static string Make(size_t size) { return string(size, 'x'); }
+	static size_t Size(const string& c) { return c.size(); }
+	static void Insert(string& c, size_t index, char item) { c.insert(begin(c) + index, item); }
+	static void Insert(string& c, size_t index, const string& items) { c.insert(index, items); }
+	static void Erase(string& c, size_t index, size_t count) { c.erase(index, count); }
+	static char At(const string& c, size_t index) { return c[index]; }
+};
+
+template <> struct operations<deque<char>> {
+	static deque<char> Make(size_t size) { return deque<char>(size, 'x'); }
+	static size_t Size(const deque<char>& c) { return c.size(); }
+	static void Insert(deque<char>& c, size_t index, char item) { c.insert(begin(c) + index, item); }
+	static void Insert(deque<char>& c, size_t index, const string& items) { c.insert(begin(c) + index, begin(items), end(items)); }
+	static void Erase(deque<char>& c, size_t index, size_t count) { c.erase(begin(c) + index, begin(c) + index + count); }
+	static char At(const deque<char>& c, size_t index) { return c[index]; }
+};
+
+#if GAPBUFFER_BENCHMARK_ROPE
+using rope = __gnu_cxx::crope;
+
+template <> struct operations<rope> {
+	static rope Make(size_t size) { return rope(size, 'x'); }
+	static size_t Size(const rope& c) { return c.size(); }
+	static void Insert(rope& c, size_t index, char item) { c.insert(index, item); }
+	static void Insert(rope& c, size_t index, const string& items) { c.insert(index, items.data(), items.size()); }
+	static void Erase(rope& c, size_t index, size_t count) { c.erase(index, count); }
+	static char At(const rope& c, size_t index) { return c[index]; }
+};
+#endif
+
+//Document sizes: 1 KB, 32 KB, 1 MB, 32 MB and 1 GB
+static void Sizes(benchmark::internal::Benchmark* b) {
+	for (int64_t size : { int64_t(1) << 10, int64_t(32) << 10, int64_t(1) << 20, int64_t(32) << 20, int64_t(1) << 30 })
+		b->Arg(size);
+}
+
+//Random positions are taken from the table, so the generator isn't measured
+static vector<size_t> RandomPositions() {
+	mt19937_64 random(42);
+	vector<size_t> positions(1 << 12);
+	for (size_t& position : positions)
+		position = random();
+	return positions;
+}
+
+//Typing at the cursor in the middle of the document, the cursor goes forward
+template <class Container>
+static void BM_SequentialTyping(benchmark::State& state) {
+	using ops = operations<Container>;
+	Container c = ops::Make(state.range(0));
+	size_t cursor = ops::Size(c) / 2;
+	for (auto _ : state)
+		ops::Insert(c, cursor++, 'y');
+	state.SetItemsProcessed(state.iterations());
+}
+
+//Inserts at random positions, the gap buffer moves the gap by the third of the data in average
+template <class Container>
+static void BM_RandomInsert(benchmark::State& state) {
+	using ops = operations<Container>;
+	Container c = ops::Make(state.range(0));
+	const vector<size_t> positions = RandomPositions();
+	size_t i = 0;
+	for (auto _ : state)
+		ops::Insert(c, positions[i++ % positions.size()] % (ops::Size(c) + 1), 'y');
+	state.SetItemsProcessed(state.iterations());
+}
+
+//Backspaces before the cursor, the removed text is typed again by one paste when the
+//cursor comes to the start, the paste is not measured
+template <class Container>
+static void BM_BackspaceStorm(benchmark::State& state) {
+	using ops = operations<Container>;
+	Container c = ops::Make(state.range(0));
+	const size_t start = ops::Size(c) / 2;
+	size_t cursor = start;
+	for (auto _ : state) {
+		if (cursor == 0) {
+			state.PauseTiming();
+			ops::Insert(c, 0, string(start, 'x'));
+			cursor = start;
+			state.ResumeTiming();
+		}
+		ops::Erase(c, --cursor, 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+//Removal of 4 KB or the quarter of a small document at a random position and the paste of it back
+template <class Container>
+static void BM_RangeEraseAndPaste(benchmark::State& state) {
+	using ops = operations<Container>;
+	Container c = ops::Make(state.range(0));
+	const size_t count = min<size_t>(4 << 10, state.range(0) / 4);
+	const string paste(count, 'x');
+	const vector<size_t> positions = RandomPositions();
+	size_t i = 0;
+	for (auto _ : state) {
+		const size_t index = positions[i++ % positions.size()] % (ops::Size(c) - count);
+		ops::Erase(c, index, count);
+		ops::Insert(c, index, paste);
+	}
+	state.SetBytesProcessed(state.iterations() * count * 2);
+}
+
+//Walk through the whole document with the gap in the middle
+template <class Container>
+static void BM_FullIteration(benchmark::State& state) {
+	using ops = operations<Container>;
+	Container c = ops::Make(state.range(0));
+	ops::Insert(c, ops::Size(c) / 2, 'y');
+	const Container& view = c;
+	for (auto _ : state) {
+		size_t count = 0;
+		for (auto it = begin(view); it != end(view); ++it)
+			count += *it == 'y';
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+//Access to random elements, the gap buffer goes through iterator::operator[]
+template <class Container>
+static void BM_RandomAccess(benchmark::State& state) {
+	using ops = operations<Container>;
+	Container c = ops::Make(state.range(0));
+	ops::Insert(c, ops::Size(c) / 2, 'y');
+	const vector<size_t> positions = RandomPositions();
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(ops::At(c, positions[i++ % positions.size()] % ops::Size(c)));
+	state.SetItemsProcessed(state.iterations());
+}
+
+#if GAPBUFFER_BENCHMARK_ROPE
+#define GAPBUFFER_CONTAINERS(name, sizes) \
+	BENCHMARK_TEMPLATE(name, GapBuffer)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, ChunkedGapBuffer)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, string)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, deque<char>)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, rope)->Apply(sizes)
+#else
+#define GAPBUFFER_CONTAINERS(name, sizes) \
+	BENCHMARK_TEMPLATE(name, GapBuffer)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, ChunkedGapBuffer)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, string)->Apply(sizes); \
+	BENCHMARK_TEMPLATE(name, deque<char>)->Apply(sizes)
+#endif
+
+GAPBUFFER_CONTAINERS(BM_SequentialTyping, Sizes);
+GAPBUFFER_CONTAINERS(BM_RandomInsert, Sizes);
+GAPBUFFER_CONTAINERS(BM_BackspaceStorm, Sizes);
+GAPBUFFER_CONTAINERS(BM_RangeEraseAndPaste, Sizes);
+GAPBUFFER_CONTAINERS(BM_FullIteration, Sizes);
+GAPBUFFER_CONTAINERS(BM_RandomAccess, Sizes);
+
+//Gap moves over the distances from 64 B to the half of the data: the insert at the distance
+//from the gap and the erase of it, so every iteration moves the gap there and back
+static void BM_GapMoveDistance(benchmark::State& state) {
+	GapBuffer gp;
+	gp.Insert(0, state.range(0), 'x');
+	const size_t near = gp.Size() / 4;
+	const size_t far = near + state.range(1);
+	gp.Insert(near, 'y');
+	for (auto _ : state) {
+		gp.Insert(far, 'y');
+		gp.Erase(cbegin(gp) + far);
+		gp.Insert(near, 'y');
+		gp.Erase(cbegin(gp) + near);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(1) * 2);
+}
+BENCHMARK(BM_GapMoveDistance)->ArgsProduct({ { 1 << 20, int64_t(1) << 30 }, { 64, 4 << 10, 256 << 10, 512 << 10 } });
+BENCHMARK(BM_GapMoveDistance)->Args({ int64_t(1) << 30, 16 << 20 })->Args({ int64_t(1) << 30, 512 << 20 });
@@ -0,0 +1,65 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace std;
+
+constexpr size_t document_size = 1 << 30;
+
+//Lines of 80 bytes, the gap is in the middle of the data
+static const GapBuffer& Document() {
+	static const GapBuffer gp = [] {
+		GapBuffer result;
+		result.Insert(0, document_size, 'x');
+		for (size_t i = 0; i < document_size; i += 80)
+			*(begin(result) + i) = '\n';
+		result.Insert(document_size / 2, 'y');
+		result.Erase(cbegin(result) + document_size / 2);
+		return result;
+	}();
+	return gp;
+}
+
+//Thread counts: 1 to 16, the time should go down almost linearly while the memory bandwidth lasts
+static void Threads(benchmark::internal::Benchmark* b) {
+	for (int threads : { 1, 2, 4, 8, 16 })
+		b->Arg(threads);
+	b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+static void BM_ParallelCountLines(benchmark::State& state) {
+	const GapBuffer& gp = Document();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.ParallelLineCount(state.range(0)));
+	state.SetBytesProcessed(state.iterations() * document_size);
+}
+BENCHMARK(BM_ParallelCountLines)->Apply(Threads);
+
+//The needle is absent, so every block is searched
+static void BM_ParallelFind(benchmark::State& state) {
+	const GapBuffer& gp = Document();
+	const string needle = "xxy\n";
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.ParallelFind(needle, state.range(0)));
+	state.SetBytesProcessed(state.iterations() * document_size);
+}
+BENCHMARK(BM_ParallelFind)->Apply(Threads);
+
+static void BM_ParallelHash(benchmark::State& state) {
+	const GapBuffer& gp = Document();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.ParallelHash(state.range(0)));
+	state.SetBytesProcessed(state.iterations() * document_size);
+}
+BENCHMARK(BM_ParallelHash)->Apply(Threads);
+
+//Count through the iterators, as it was done before
+static void BM_IteratorCountLines(benchmark::State& state) {
+	const GapBuffer& gp = Document();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(count(cbegin(gp), cend(gp), '\n'));
+	state.SetBytesProcessed(state.iterations() * document_size);
+}
+BENCHMARK(BM_IteratorCountLines)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,78 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <regex>
+#include <string>
+
+using namespace std;
+
+constexpr size_t document_size = 200 << 20;
+
+//Lines of filler with the replaced word in every 2 KB, 100k matches in 200 MB
+static string Document(size_t size) {
+	const string line = string(2'040, '.') + " word ";
+	string text;
+	text.reserve(size + line.size());
+	while (text.size() < size)
+		text += line;
+	return text;
+}
+
+//All matches are found and the data is rebuilt once, the buffer is filled anew every time
+static void BM_ReplaceAll(benchmark::State& state) {
+	const string text = Document(document_size);
+	const string pattern = "word", replacement = "replacement";
+	double speed = 0.0;
+	size_t count = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, begin(text), end(text));
+		state.ResumeTiming();
+		const auto report = gp.ReplaceAll(pattern, replacement);
+		speed = report.megabytes_per_second;
+		count = report.count;
+	}
+	state.counters["matches"] = static_cast<double>(count);
+	state.counters["MB/s"] = speed;
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ReplaceAll)->Unit(benchmark::kMillisecond);
+
+//std::regex goes through the iterators which cross the gap
+static void BM_ReplaceAllRegex(benchmark::State& state) {
+	const string text = Document(state.range(0));
+	const regex pattern("w(or)d");
+	const string format = "$1";
+	double speed = 0.0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, begin(text), end(text));
+		state.ResumeTiming();
+		speed = gp.ReplaceAll(pattern, format).megabytes_per_second;
+	}
+	state.counters["MB/s"] = speed;
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ReplaceAllRegex)->Arg(1 << 20)->Arg(16 << 20)->Unit(benchmark::kMillisecond);
+
+//Erase and Insert for every match, as it was done before. The gap goes forward after
+//the matches, but every pair is two edits and the storage grows many times on the way.
+static void BM_EraseInsertEach(benchmark::State& state) {
+	const string text = Document(state.range(0));
+	const string pattern = "word", replacement = "replacement";
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, begin(text), end(text));
+		state.ResumeTiming();
+		for (size_t pos = gp.Find(pattern); pos != GapBuffer::npos; pos = gp.Find(pattern, pos + replacement.size())) {
+			gp.Erase(cbegin(gp) + pos, cbegin(gp) + pos + pattern.size());
+			gp.Insert(pos, replacement);
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_EraseInsertEach)->Arg(16 << 20)->Arg(document_size)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,50 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+static const filesystem::path save_path = filesystem::temp_directory_path() / "gapbuffer_benchmark.save";
+
+//The buffer of the size with the gap in the middle
+static GapBuffer MakeBuffer(const size_t& size) {
+	GapBuffer gp(size + 1);
+	gp.Insert(0, size, 'x');
+	gp.Insert(size / 2, '\n');
+	return gp;
+}
+
+//Sizes of 64 MB and 1 GB with every sync mode
+static void SaveModes(benchmark::internal::Benchmark* b) {
+	b->ArgNames({ "bytes", "sync" })->Unit(benchmark::kMillisecond)->UseRealTime();
+	for (int64_t size : { int64_t(64) << 20, int64_t(1) << 30 })
+		for (auto sync : { save_sync::none, save_sync::data, save_sync::range, save_sync::direct })
+			b->Args({ size, static_cast<int64_t>(sync) });
+}
+
+static void BM_SaveTo(benchmark::State& state) {
+	const GapBuffer gp = MakeBuffer(state.range(0));
+	const save_options options{ true, static_cast<save_sync>(state.range(1)) };
+	for (auto _ : state)
+		gp.SaveTo(save_path, options);
+	state.SetBytesProcessed(state.iterations() * gp.Size());
+	filesystem::remove(save_path);
+}
+BENCHMARK(BM_SaveTo)->Apply(SaveModes);
+
+//Saving through the iterators, as the data had to be saved before
+static void BM_SaveByIterator(benchmark::State& state) {
+	const GapBuffer gp = MakeBuffer(state.range(0));
+	for (auto _ : state) {
+		ofstream out(save_path, ios::binary | ios::trunc);
+		copy(cbegin(gp), cend(gp), ostreambuf_iterator<char>(out));
+	}
+	state.SetBytesProcessed(state.iterations() * gp.Size());
+	filesystem::remove(save_path);
+}
+BENCHMARK(BM_SaveByIterator)->Arg(64 << 20)->Unit(benchmark::kMillisecond)->UseRealTime();
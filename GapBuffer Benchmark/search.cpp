@@ -0,0 +1,105 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/Kernels.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <string>
+
+using namespace std;
+
+constexpr size_t haystack_size = 1 << 30;
+
+//Random letters with the needle in the end, so the whole haystack is scanned.
+//The needle has the symbol which the letters don't have, so it isn't found before the end.
+//The gap is in the middle of the data.
+static string Needle(size_t size) {
+	string needle(size, 'q');
+	for (size_t i = 0; i < size; ++i)
+		needle[i] = 'a' + (i * 7) % 26;
+	needle[size / 2] = '_';
+	return needle;
+}
+
+static string Haystack(size_t needle_size) {
+	string text(haystack_size, ' ');
+	mt19937 random(42);
+	for (char& c : text)
+		c = 'a' + random() % 26;
+	const string needle = Needle(needle_size);
+	copy(begin(needle), end(needle), end(text) - needle_size);
+	return text;
+}
+
+static GapBuffer& Document(size_t needle_size) {
+	static size_t filled_for = 0;
+	static GapBuffer gp;
+	if (filled_for != needle_size) {
+		const string text = Haystack(needle_size);
+		gp.Clear();
+		gp.Insert(0, begin(text), end(text));
+		gp.Insert(haystack_size / 2, 'y');
+		gp.Erase(cbegin(gp) + haystack_size / 2);
+		filled_for = needle_size;
+	}
+	return gp;
+}
+
+//Needle sizes: 4, 16 and 64 bytes
+static void NeedleSizes(benchmark::internal::Benchmark* b) {
+	for (int size : { 4, 16, 64 })
+		b->Arg(size);
+	b->Unit(benchmark::kMillisecond);
+}
+
+//Search over the segments of the gap buffer by the detected kernel
+static void BM_GapBufferFind(benchmark::State& state) {
+	const GapBuffer& gp = Document(state.range(0));
+	const string needle = Needle(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.Find(needle));
+	state.SetBytesProcessed(state.iterations() * haystack_size);
+}
+BENCHMARK(BM_GapBufferFind)->Apply(NeedleSizes);
+
+//The last match is the first one for the backward search, so the first block has it.
+//The needle in the start of the haystack makes the backward search scan everything.
+static void BM_GapBufferRFind(benchmark::State& state) {
+	const GapBuffer& gp = Document(state.range(0));
+	const string needle = Needle(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.RFind(needle, haystack_size - needle.size() - 1));
+	state.SetBytesProcessed(state.iterations() * haystack_size);
+}
+BENCHMARK(BM_GapBufferRFind)->Apply(NeedleSizes);
+
+//Kernels of every level over the flat haystack
+static void BM_FindBytes(benchmark::State& state) {
+	const byte_kernels& kernels = ByteKernels(static_cast<simd_level>(state.range(1)));
+	const string text = Haystack(state.range(0));
+	const string needle = Needle(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(kernels.find_bytes(text.data(), text.data() + text.size(), needle.data(), needle.size()));
+	state.SetBytesProcessed(state.iterations() * haystack_size);
+}
+BENCHMARK(BM_FindBytes)->ArgsProduct({ { 4, 16, 64 }, { static_cast<int>(simd_level::portable), static_cast<int>(simd_level::sse2), static_cast<int>(simd_level::avx2) } })->Unit(benchmark::kMillisecond);
+
+//std::search through the gap buffer iterators, as the search was done before
+static void BM_IteratorSearch(benchmark::State& state) {
+	const GapBuffer& gp = Document(state.range(0));
+	const string needle = Needle(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(search(cbegin(gp), cend(gp), begin(needle), end(needle)));
+	state.SetBytesProcessed(state.iterations() * haystack_size);
+}
+BENCHMARK(BM_IteratorSearch)->Apply(NeedleSizes);
+
+static void BM_StringFind(benchmark::State& state) {
+	const string text = Haystack(state.range(0));
+	const string needle = Needle(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(text.find(needle));
+	state.SetBytesProcessed(state.iterations() * haystack_size);
+}
+BENCHMARK(BM_StringFind)->Apply(NeedleSizes);
@@ -0,0 +1,52 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/ChunkedGapBuffer.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+
+using namespace std;
+
+constexpr size_t document_size = 500 << 20;
+
+static ChunkedGapBuffer& Document() {
+	static ChunkedGapBuffer gp = [] {
+		ChunkedGapBuffer result;
+		result.Insert(0, document_size, 'x');
+		return result;
+	}();
+	return gp;
+}
+
+//Snapshot shares the leaves, only the leaf pointers and their sizes are copied
+static void BM_Snapshot(benchmark::State& state) {
+	const ChunkedGapBuffer& gp = Document();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.Snapshot());
+	state.counters["leaves"] = static_cast<double>(gp.LeafCount());
+}
+BENCHMARK(BM_Snapshot)->Unit(benchmark::kMicrosecond);
+
+//The first edit after the snapshot copies its leaf
+static void BM_SnapshotAndEdit(benchmark::State& state) {
+	ChunkedGapBuffer& gp = Document();
+	for (auto _ : state) {
+		const auto snapshot = gp.Snapshot();
+		gp.Insert(gp.Size() / 2, 'y');
+		gp.Erase(cbegin(gp) + gp.Size() / 2);
+		benchmark::DoNotOptimize(snapshot->Size());
+	}
+}
+BENCHMARK(BM_SnapshotAndEdit)->Unit(benchmark::kMicrosecond);
+
+//Full copy of the flat buffer, as the snapshots were taken before
+static void BM_FlatCopy(benchmark::State& state) {
+	GapBuffer gp;
+	gp.Insert(0, document_size, 'x');
+	GapBuffer copy;
+	for (auto _ : state) {
+		copy = gp;
+		benchmark::DoNotOptimize(copy.Size());
+	}
+}
+BENCHMARK(BM_FlatCopy)->Unit(benchmark::kMicrosecond);
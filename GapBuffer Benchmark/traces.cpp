@@ -0,0 +1,107 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+
+//Edit traces replayed with the default and the adaptive growth policy, the argument
+//is the policy. The traces are recorded from the editing models below once,
+//so the generators aren't measured. StorageSize in the end shows the memory of the gap.
+
+using namespace std;
+
+constexpr size_t document_size = 4 << 20;
+constexpr size_t trace_size = 1 << 12;                              //Edits of every trace
+
+//Replacement of erase elements from offset by the text
+struct trace_edit {
+	size_t offset;
+	size_t erase;
+	string text;
+};
+
+//Records the edits and keeps the document size to place the next ones
+class trace_recorder {
+  public:
+	explicit trace_recorder(const size_t& size) : size(size) { }
+	void Edit(const size_t& offset, const size_t& erase, string text) { size = size - erase + text.size(); edits.push_back({ offset, erase, move(text) }); }
+	size_t Size() const { return size; }
+	vector<trace_edit> Edits() && { return move(edits); }
+
+  private:
+	size_t size;
+	vector<trace_edit> edits;
+};
+
+//The log tail gets the entries and the counter in the header is overwritten after every one
+static vector<trace_edit> LogAndHeader() {
+	trace_recorder trace(document_size);
+	for (size_t i = 0; i < trace_size / 2; ++i) {
+		trace.Edit(trace.Size(), 0, "entry " + to_string(i) + '\n');
+		trace.Edit(16, 8, to_string(10'000'000 + i));
+	}
+	return move(trace).Edits();
+}
+
+//Two cursors in the quarters of the document type the words in turn
+static vector<trace_edit> TwoCursors() {
+	trace_recorder trace(document_size);
+	size_t cursors[2] = { document_size / 4, document_size * 3 / 4 };
+	for (size_t i = 0; i < trace_size; ++i) {
+		const string word = i % 7 == 0 ? "\n" : "word ";
+		const size_t cursor = i % 2;
+		trace.Edit(cursors[cursor], 0, word);
+		cursors[cursor] += word.size();
+		if (cursor == 0)
+			cursors[1] += word.size();
+	}
+	return move(trace).Edits();
+}
+
+//Typing with backspaces at one cursor which jumps to a random place after every 64 edits
+static vector<trace_edit> TypingSession() {
+	trace_recorder trace(document_size);
+	mt19937_64 random(42);
+	size_t cursor = document_size / 2;
+	for (size_t i = 0; i < trace_size; ++i) {
+		if (i % 64 == 0)
+			cursor = random() % trace.Size();
+		if (i % 5 == 4 && cursor > 0)
+			trace.Edit(--cursor, 1, "");
+		else
+			trace.Edit(cursor++, 0, "a");
+	}
+	return move(trace).Edits();
+}
+
+static void Replay(GapBuffer& gp, const vector<trace_edit>& trace) {
+	for (const trace_edit& edit : trace) {
+		if (edit.erase != 0)
+			gp.Erase(cbegin(gp) + edit.offset, cbegin(gp) + edit.offset + edit.erase);
+		if (!edit.text.empty())
+			gp.Insert(edit.offset, edit.text);
+	}
+}
+
+static void BM_Trace(benchmark::State& state, vector<trace_edit> (*record)()) {
+	const vector<trace_edit> trace = record();
+	GapBuffer::growth_policy policy;
+	policy.adaptive = state.range(0) != 0;
+	size_t storage = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		GapBuffer gp;
+		gp.Insert(0, document_size, 'x');
+		gp.SetGrowthPolicy(policy);
+		state.ResumeTiming();
+		Replay(gp, trace);
+		storage = gp.StorageSize();
+	}
+	state.counters["storage_MB"] = static_cast<double>(storage) / (1 << 20);
+	state.SetItemsProcessed(state.iterations() * trace.size());
+}
+BENCHMARK_CAPTURE(BM_Trace, log_and_header, LogAndHeader)->ArgName("adaptive")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Trace, two_cursors, TwoCursors)->ArgName("adaptive")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Trace, typing_session, TypingSession)->ArgName("adaptive")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,58 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+using namespace std;
+
+constexpr size_t document_size = 100 << 20;
+constexpr size_t window = 1 << 20;                                  //Edits go around the caret in the middle of the document
+
+//Typing, pasting and removals at random positions of the window, every step is one undo record
+static void Edit(GapBuffer& gp, const size_t& steps) {
+	const string word = "pasted ";
+	mt19937_64 random(42);
+	for (size_t i = 0; i < steps; ++i) {
+		const size_t index = document_size / 2 + random() % window;
+		switch (i % 3) {
+		case 0:
+			gp.Insert(index, 'y');
+			break;
+		case 1:
+			gp.Insert(index, begin(word), end(word));
+			break;
+		default:
+			gp.Erase(cbegin(gp) + index, cbegin(gp) + index + 5);
+		}
+	}
+}
+
+//Undo of all steps and redo of them, the journal keeps the deltas only
+static void BM_UndoRedo(benchmark::State& state) {
+	GapBuffer gp(document_size + window);
+	gp.Insert(0, document_size, 'x');
+	gp.EnableUndo();
+	Edit(gp, state.range(0));
+	for (auto _ : state) {
+		while (gp.Undo()) { }
+		while (gp.Redo()) { }
+	}
+	state.counters["journal_bytes"] = static_cast<double>(gp.UndoMemory());
+	state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_UndoRedo)->Arg(10'000)->Unit(benchmark::kMillisecond);
+
+//Snapshot of the whole buffer by the copy, as it was done before the journal
+static void BM_SnapshotCopy(benchmark::State& state) {
+	GapBuffer gp(document_size + window);
+	gp.Insert(0, document_size, 'x');
+	GapBuffer snapshot;
+	for (auto _ : state) {
+		snapshot = gp;
+		benchmark::DoNotOptimize(snapshot.Size());
+	}
+	state.SetBytesProcessed(state.iterations() * gp.StorageSize());
+}
+BENCHMARK(BM_SnapshotCopy)->Unit(benchmark::kMillisecond);
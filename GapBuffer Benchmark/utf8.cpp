@@ -0,0 +1,86 @@
+#include "../GapBuffer/GapBuffer.h"
+#include "../GapBuffer/iterator.h"
+#include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/Kernels.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+using namespace std;
+
+constexpr size_t document_size = 1 << 30;
+
+//Mixed text of 1, 2 and 3 byte code points, the gap is in the middle of the data
+static string Text(size_t size) {
+	string text;
+	text.reserve(size + 3);
+	for (size_t i = 0; text.size() < size; ++i)
+		text += i % 7 == 0 ? "\xE2\x82\xAC" : i % 5 == 0 ? "\xC3\xA9" : "a";
+	return text;
+}
+
+static GapBuffer& Document() {
+	static GapBuffer gp = [] {
+		const string text = Text(document_size);
+		GapBuffer result;
+		result.Insert(0, text);
+		result.Insert(result.PrevCodePoint(result.Size() / 2), 'y');
+		result.EnableCodePointIndex();
+		return result;
+	}();
+	return gp;
+}
+
+//Seek of the random code point by the sampled index, it's O(log n)
+static void BM_CodePointSeek(benchmark::State& state) {
+	const GapBuffer& gp = Document();
+	const size_t count = gp.CodePointCount();
+	mt19937_64 random(42);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(gp.OffsetOfCodePoint(random() % count));
+}
+BENCHMARK(BM_CodePointSeek);
+
+//The typing updates the counts of one chunk
+static void BM_TypingWithIndex(benchmark::State& state) {
+	GapBuffer& gp = Document();
+	const size_t index = gp.PrevCodePoint(gp.Size() / 3);
+	const string letter = "\xC3\xA9";
+	for (auto _ : state) {
+		gp.Insert(index, letter);
+		gp.Erase(cbegin(gp) + index, cbegin(gp) + index + 2);
+	}
+}
+BENCHMARK(BM_TypingWithIndex);
+
+//Cursor movement by one code point back and forth
+static void BM_NextPrevCodePoint(benchmark::State& state) {
+	const GapBuffer& gp = Document();
+	size_t index = gp.Size() / 2;
+	for (auto _ : state) {
+		index = gp.NextCodePoint(index);
+		index = gp.PrevCodePoint(index);
+		benchmark::DoNotOptimize(index);
+	}
+}
+BENCHMARK(BM_NextPrevCodePoint);
+
+//Kernels of every level over the flat text
+static void BM_CountCodePoints(benchmark::State& state) {
+	const byte_kernels& kernels = ByteKernels(static_cast<simd_level>(state.range(0)));
+	const string text = Text(64 << 20);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(kernels.count_code_points(text.data(), text.data() + text.size()));
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_CountCodePoints)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+//ASCII text is skipped by blocks, the mixed one goes by sequences
+static void BM_ValidateUtf8(benchmark::State& state) {
+	const byte_kernels& kernels = ByteKernels(static_cast<simd_level>(state.range(0)));
+	const string text = state.range(1) ? Text(64 << 20) : string(64 << 20, 'a');
+	for (auto _ : state)
+		benchmark::DoNotOptimize(kernels.validate_utf8(text.data(), text.data() + text.size()));
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ValidateUtf8)->ArgsProduct({ { 0, 1, 2 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
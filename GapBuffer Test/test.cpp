@@ -2,11 +2,28 @@
 #include "../GapBuffer/GapBuffer.h"
 #include "../GapBuffer/iterator.h"
 #include "../GapBuffer/const_iterator.h"
+#include "../GapBuffer/Kernels.h"
+#include "../GapBuffer/ChunkedGapBuffer.h"
+#include "../GapBuffer/ConcurrentGapBuffer.h"
 #include <string>
 #include <vector>
 #include <numeric>
 #include <string_view>
 #include <type_traits>
+#include <span>
+#include <cstdint>
+#include <memory_resource>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <random>
+#include <future>
+#include <regex>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 using namespace std;
 
@@ -42,7 +59,7 @@ bool IsGapPairEqual(const pair<size_t, size_t>& lhs, const pair<size_t, size_t>&
 TEST_F(GapBufferTest, 1_InsertByIndex) {
 	gp_first.Insert(4, 'e');
 	gp_first.Insert(5, 'f');
-	vector<char>& data = gp_first.getGapData();
+	const vector<char>& data = gp_first.getGapData();
 	string to_compare = "abcdefgh";
 	EXPECT_TRUE(equal(begin(data), end(data), begin(to_compare))) << "Insert function mistake.e";
 	EXPECT_TRUE(IsGapPairEqual(gp_first.getGapPos(), make_pair(6, 6))) << "Gap Buffer isn't in a right position after the insertion.";
@@ -51,7 +68,7 @@ TEST_F(GapBufferTest, 1_InsertByIndex) {
 TEST_F(GapBufferTest, 2_InsertByIndex) {
 	gp_second.Insert(0, '1');
 	gp_second.Insert(1, '2');
-	vector<char>& data = gp_second.getGapData();
+	const vector<char>& data = gp_second.getGapData();
 	auto end_data = find(begin(data), end(data), '\0');
 	string to_compare = "123456789";
 	EXPECT_TRUE(equal(begin(data), end_data, begin(to_compare))) << "Insert function mistake.";
@@ -63,7 +80,7 @@ TEST_F(GapBufferTest, 3_InsertByIndex) {
 	for (string::size_type i = 1; i < to_compare.size() - 1; ++i)
 		gp_third.Insert(i, to_compare[i]);
 
-	vector<char>& data = gp_third.getGapData();
+	const vector<char>& data = gp_third.getGapData();
 	auto end_data = find(begin(data), end(data), '\0');
 	EXPECT_TRUE(equal(begin(data), end_data, begin(to_compare))) << "Insert function mistake.";
 	EXPECT_TRUE(IsGapPairEqual(gp_third.getGapPos(), make_pair(8, 8))) << "Gap Buffer isn't in a right position after the insertion.";
@@ -75,7 +92,7 @@ TEST_F(GapBufferTest, 4_InsertByIndex) {
 	for (string::size_type i = 10'000; i < 19'500; ++i)
 	    gp_fourth.Insert(i, to_compare[i]);
 
-	vector<char>& data = gp_fourth.getGapData();
+	const vector<char>& data = gp_fourth.getGapData();
 	auto end_data = find(begin(data), end(data), '\0');
 	EXPECT_TRUE(equal(begin(data), end_data, begin(to_compare))) << "Insert function mistake.";
 	EXPECT_TRUE(IsGapPairEqual(gp_fourth.getGapPos(), make_pair(19'500, 19'500))) << "Gap Buffer isn't in a right position after the insertion.";
@@ -86,7 +103,7 @@ TEST_F(GapBufferTest, 1_InsertByIterator) {
 	GapBuffer::const_iterator iter = cbegin(gp_first) + 4;
 	gp_first.Insert(iter, 'e');
 	gp_first.Insert(iter, 'f');
-	vector<char>& data = gp_first.getGapData();
+	const vector<char>& data = gp_first.getGapData();
 	EXPECT_TRUE(equal(begin(data), end(data), begin(to_compare))) << "Insert function mistake";
 	EXPECT_TRUE(IsGapPairEqual(gp_first.getGapPos(), make_pair(6, 6))) << "Gap Buffer isn't in a right position after the insertion.";;
 }
@@ -95,7 +112,7 @@ TEST_F(GapBufferTest, 2_InsertByIterator) {
 	GapBuffer::const_iterator iter = cbegin(gp_second);
 	gp_second.Insert(iter, '1');
 	gp_second.Insert(iter, '2');
-	vector<char>& data = gp_second.getGapData();
+	const vector<char>& data = gp_second.getGapData();
 	auto end_data = find(begin(data), end(data), '\0');
 	string to_compare = "123456789";
 	EXPECT_TRUE(equal(begin(data), end_data, begin(to_compare))) << "Insert function mistake.";
@@ -111,7 +128,7 @@ TEST_F(GapBufferTest, 3_InsertByIterator) {
 	for (auto ch : sv)
 		gp_third.Insert(iter, ch);
 
-	vector<char>& data = gp_third.getGapData();
+	const vector<char>& data = gp_third.getGapData();
 	auto end_data = find(begin(data), end(data), '\0');
 	EXPECT_TRUE(equal(begin(data), end_data, begin(to_compare))) << "Insert function mistake.";
 	EXPECT_TRUE(IsGapPairEqual(gp_third.getGapPos(), make_pair(8, 8))) << "Gap Buffer isn't in a right position after the insertion.";
@@ -129,11 +146,583 @@ TEST_F(GapBufferTest, 4_InsertByIterator) {
 	for (auto ch : cmp)
 		gp_fourth.Insert(iter, ch);
 
-	vector<char>& data = gp_fourth.getGapData();
+	const vector<char>& data = gp_fourth.getGapData();
 	auto end_data = find(begin(data), end(data), '\0');
 	EXPECT_TRUE(equal(begin(data), end_data, begin(to_compare))) << "Insert function mistake.";
 	EXPECT_TRUE(IsGapPairEqual(gp_fourth.getGapPos(), make_pair(19'500, 19'500))) << "Gap Buffer isn't in a right position after the insertion.";
 }
+TEST_F(GapBufferTest, 1_InsertRange) {
+	string to_insert = "ef";
+	gp_first.Insert(4, begin(to_insert), end(to_insert));
+	string to_compare = "abcdefgh";
+	EXPECT_TRUE(equal(begin(gp_first), end(gp_first), begin(to_compare))) << "Insert range function mistake.";
+	EXPECT_TRUE(IsGapPairEqual(gp_first.getGapPos(), make_pair(6, 6))) << "Gap Buffer isn't in a right position after the insertion.";
+}
+
+TEST_F(GapBufferTest, 2_InsertRange) {
+	GapBuffer gp;
+	gp.Insert(0, string_view("3456789"));
+	gp.Insert(3, string_view("abcdef"));
+	string to_compare = "345abcdef6789";
+	EXPECT_EQ(gp.Size(), 13) << "Insert string_view didn't expand the storage.";
+	auto data = gp.getGapData();
+	auto gap = gp.getGapPos();
+	EXPECT_EQ(gap.first, 9) << "Gap Buffer isn't in a right position after the insertion.";
+	EXPECT_TRUE(equal(begin(data), begin(data) + gap.first, begin(to_compare))) << "Insert string_view function mistake.";
+	EXPECT_TRUE(equal(begin(data) + gap.second, end(data), begin(to_compare) + gap.first)) << "Insert string_view function mistake.";
+}
+
+TEST_F(GapBufferTest, 3_InsertRange) {
+	gp_fourth.Insert(10'000, 9'500, '+');
+	string to_compare(25'000, '+');
+	EXPECT_TRUE(equal(begin(gp_fourth), end(gp_fourth), begin(to_compare))) << "Insert count function mistake.";
+	EXPECT_TRUE(IsGapPairEqual(gp_fourth.getGapPos(), make_pair(19'500, 19'500))) << "Gap Buffer isn't in a right position after the insertion.";
+	EXPECT_THROW(gp_fourth.Insert(gp_fourth.Size() + 1, string_view("+")), invalid_argument);
+}
+
+TEST_F(GapBufferTest, BinaryData) {
+	const string binary("a\0b\0\0c", 6);
+	GapBuffer gp;
+	gp.Insert(0, string_view(binary));
+	gp.Insert(3, '\0');
+	gp.Insert(0, '\0');
+	const string to_compare("\0a\0b\0\0\0c", 8);
+	EXPECT_EQ(end(gp) - begin(gp), 8) << "end() must not stop at the null symbol.";
+	EXPECT_TRUE(equal(cbegin(gp), cend(gp), begin(to_compare))) << "Binary data is corrupted.";
+	EXPECT_EQ(*(cend(gp) - 1), 'c');
+}
+
+TEST_F(GapBufferTest, EndPosition) {
+	EXPECT_EQ(*(end(gp_first) - 1), 'h');
+	EXPECT_EQ(end(gp_second) - begin(gp_second), 7);
+	gp_first.Insert(gp_first.Size(), string_view("ij"));
+	EXPECT_EQ(end(gp_first) - begin(gp_first), 8) << "end() is wrong when the gap is at the end.";
+	EXPECT_EQ(*(end(gp_first) - 1), 'j');
+}
+
+TEST_F(GapBufferTest, Segments) {
+	auto [before, after] = gp_first.Segments();
+	EXPECT_EQ(string(begin(before), end(before)), "abcd");
+	EXPECT_EQ(string(begin(after), end(after)), "gh");
+	EXPECT_TRUE(IsGapPairEqual(gp_first.getGapPos(), make_pair(4, 6))) << "Segments mustn't move the gap.";
+
+	auto [empty, whole] = gp_second.Segments();
+	EXPECT_TRUE(empty.empty());
+	EXPECT_EQ(string(begin(whole), end(whole)), "3456789");
+}
+
+TEST_F(GapBufferTest, ContiguousView) {
+	auto view = gp_first.ContiguousView();
+	EXPECT_EQ(string(begin(view), end(view)), "abcdgh");
+	EXPECT_TRUE(IsGapPairEqual(gp_first.getGapPos(), make_pair(6, 8))) << "Gap should be moved to the end.";
+	EXPECT_EQ(gp_first.ContiguousView().data(), view.data()) << "Second call mustn't move data.";
+
+	auto fourth = gp_fourth.ContiguousView();
+	EXPECT_EQ(fourth.size(), 15'500);
+}
+
+TEST_F(GapBufferTest, GrowthKeepsGap) {
+	gp_first.Insert(4, string_view("123"));
+	string to_compare = "abcd123gh";
+	EXPECT_TRUE(equal(begin(gp_first), end(gp_first), begin(to_compare))) << "Growth corrupted the data.";
+	EXPECT_EQ(gp_first.StorageSize(), 6 + 3 + gp_first.GetGrowthPolicy().min_gap) << "Storage should grow up to the needed size plus the minimal gap.";
+	EXPECT_EQ(gp_first.getGapPos().first, 7) << "Growth mustn't relocate the gap.";
+
+	gp_second.Insert(7, 'x');
+	EXPECT_TRUE(IsGapPairEqual(gp_second.getGapPos(), make_pair(8, 9))) << "Gap should be moved to the end of the data.";
+	EXPECT_EQ(*(end(gp_second) - 1), 'x');
+}
+
+TEST_F(GapBufferTest, FindAndCount) {
+	EXPECT_EQ(gp_first.Find('b'), 1);
+	EXPECT_EQ(gp_first.Find('g'), 4) << "Item after the gap has a wrong index.";
+	EXPECT_EQ(gp_first.Find('b', 2), GapBuffer::npos);
+	EXPECT_EQ(gp_first.Find('h', 5), 5);
+	EXPECT_EQ(gp_first.Find('*'), GapBuffer::npos) << "Gap is searched.";
+	EXPECT_EQ(gp_third.Find('9'), 1);
+	EXPECT_EQ(gp_fourth.Find('+', 10'000), 10'000);
+	EXPECT_EQ(gp_fourth.Count('+'), 25'000 - 9'500);
+	EXPECT_EQ(gp_fourth.Count('*'), 0);
+}
+
+TEST(BasicGapBufferTest, FindNeedle) {
+	string text;
+	for (size_t i = 0; i < 3'000; ++i)
+		text += i % 11 == 0 ? "needle" : i % 7 == 0 ? "nee" : string(1, 'a' + i % 3);
+	const vector<string> needles = { "needle", "aneedleb", "ne", "c", "needleneedle", "zz" };
+	//Gap in the start, in the end, and inside of the matches
+	for (size_t gap : { size_t(0), text.size(), text.find("needle") + 3, text.rfind("needle") + 1, text.size() / 2 }) {
+		GapBuffer gp;
+		gp.Insert(0, begin(text), end(text));
+		gp.Insert(gap, 'x');
+		gp.Erase(cbegin(gp) + gap);
+		ASSERT_EQ(gp.Segments().first.size(), gap);
+		for (const string& needle : needles) {
+			for (size_t pos : { size_t(0), size_t(1), gap - min(gap, size_t(2)), gap, text.size() - 3 })
+				EXPECT_EQ(gp.Find(needle, pos), text.find(needle, pos)) << "Needle " << needle << " from " << pos << ", gap " << gap;
+			for (size_t pos : { GapBuffer::npos, gap + 2, gap, size_t(5), size_t(0) })
+				EXPECT_EQ(gp.RFind(needle, pos), text.rfind(needle, pos)) << "Needle " << needle << " before " << pos << ", gap " << gap;
+
+			vector<size_t> expected;
+			for (size_t pos = text.find(needle); pos != string::npos; pos = text.find(needle, pos + needle.size()))
+				expected.push_back(pos);
+			EXPECT_EQ(gp.FindAll(needle), expected);
+		}
+		EXPECT_EQ(gp.Segments().first.size(), gap) << "Search moved the gap.";
+	}
+
+	GapBuffer gp;
+	EXPECT_EQ(gp.Find(string("")), 0);
+	EXPECT_EQ(gp.Find(string("a")), GapBuffer::npos);
+	EXPECT_EQ(gp.RFind(string("a")), GapBuffer::npos);
+	EXPECT_TRUE(gp.FindAll(string("")).empty());
+}
+
+TEST(BasicGapBufferTest, ParallelScans) {
+	string text;
+	for (size_t i = 0; text.size() < 3 * parallel_block; ++i)
+		text += i % 13 == 0 ? "line\n" : "text ";
+	text += "needle";
+	const size_t hash = [&] {
+		GapBuffer gp;
+		gp.Insert(0, begin(text), end(text));
+		return gp.Hash();
+	}();
+	//Gap in the start, inside the needle, on the block bound and in the end
+	for (size_t gap : { size_t(0), text.size() - 3, parallel_block - 2, text.size() }) {
+		GapBuffer gp;
+		gp.Insert(0, begin(text), end(text));
+		gp.Insert(gap, 'x');
+		gp.Erase(cbegin(gp) + gap);
+		for (size_t threads : { 1, 3, 8 }) {
+			EXPECT_EQ(gp.ParallelFind('\n', threads), text.find('\n'));
+			EXPECT_EQ(gp.ParallelFind('d', threads), text.find('d')) << "Gap " << gap << ", threads " << threads;
+			EXPECT_EQ(gp.ParallelFind(string("needle"), threads), text.find("needle")) << "Gap " << gap << ", threads " << threads;
+			EXPECT_EQ(gp.ParallelFind(string("t l"), threads), text.find("t l"));
+			EXPECT_EQ(gp.ParallelFind(string("absent"), threads), GapBuffer::npos);
+			EXPECT_EQ(gp.ParallelCount('t', threads), static_cast<size_t>(count(begin(text), end(text), 't')));
+			EXPECT_EQ(gp.ParallelLineCount(threads), gp.LineCount());
+			EXPECT_EQ(gp.ParallelHash(threads), hash) << "Hash depends on the gap or the threads.";
+		}
+		EXPECT_EQ(gp.Hash(), hash);
+	}
+
+	GapBuffer other;
+	other.Insert(0, begin(text), end(text) - 1);
+	EXPECT_NE(other.Hash(), hash);
+	EXPECT_EQ(GapBuffer().ParallelFind('a'), GapBuffer::npos);
+	EXPECT_EQ(GapBuffer().ParallelCount('a'), 0);
+	EXPECT_THROW(ParallelFor(100, 4, [](size_t block) { if (block == 42) throw runtime_error("Block failed."); }), runtime_error);
+}
+
+//Line and column of every index computed by the plain scan
+vector<pair<size_t, size_t>> LineCols(const string& text) {
+	vector<pair<size_t, size_t>> result;
+	size_t line = 0, col = 0;
+	for (char c : text) {
+		result.emplace_back(line, col);
+		if (c == '\n')
+			++line, col = 0;
+		else
+			++col;
+	}
+	result.emplace_back(line, col);
+	return result;
+}
+
+TEST_F(GapBufferTest, LineIndex) {
+	for (bool indexed : { false, true }) {
+		GapBuffer gp;
+		gp.EnableLineIndex(indexed);
+		string text;
+		//Edits across the chunks, the gap moves and the storage grows
+		for (size_t i = 0; i < 3'000; ++i) {
+			const size_t index = (i * 7'919) % (text.size() + 1);
+			const char item = i % 5 == 0 ? '\n' : 'a' + i % 26;
+			gp.Insert(index, item);
+			text.insert(begin(text) + index, item);
+			if (i % 9 == 0 && text.size() > 20) {
+				gp.Erase(cbegin(gp) + index / 2, cbegin(gp) + index / 2 + 10);
+				text.erase(index / 2, 10);
+			}
+		}
+		const string line_block(2'500, '\n');
+		gp.Insert(text.size() / 3, begin(line_block), end(line_block));
+		text.insert(text.size() / 3, line_block);
+
+		EXPECT_EQ(gp.HasLineIndex(), indexed);
+		ASSERT_EQ(gp.LineCount(), count(begin(text), end(text), '\n') + 1);
+		const auto expected = LineCols(text);
+		for (size_t index = 0; index <= text.size(); index += 13)
+			EXPECT_EQ(gp.LineColOf(index), expected[index]) << "Line and column mistake, index " << index;
+		for (size_t line = 1, pos = 0; line < gp.LineCount(); line += 17) {
+			pos = 0;
+			for (size_t n = 0; n < line; ++n)
+				pos = text.find('\n', pos) + 1;
+			EXPECT_EQ(gp.OffsetOfLine(line), pos) << "Line offset mistake, line " << line;
+		}
+		EXPECT_EQ(gp.OffsetOfLine(0), 0);
+		EXPECT_THROW(gp.OffsetOfLine(gp.LineCount()), out_of_range);
+		EXPECT_THROW(gp.LineColOf(text.size() + 1), out_of_range);
+	}
+}
+
+TEST(BasicGapBufferTest, Utf8) {
+	//1, 2, 3 and 4 byte code points: a, e with acute, euro sign and G clef
+	const vector<string> letters = { "a", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9D\x84\x9E", "\n" };
+	for (bool indexed : { false, true }) {
+		GapBuffer gp;
+		gp.EnableCodePointIndex(indexed);
+		string text;
+		//Edits at code point starts across the chunks, the gap moves and the storage grows
+		for (size_t i = 0; i < 3'000; ++i) {
+			size_t index = (i * 7'919) % (text.size() + 1);
+			while (index < text.size() && (text[index] & 0xC0) == 0x80)
+				++index;
+			const string& letter = letters[i % letters.size()];
+			gp.Insert(index, letter);
+			text.insert(index, letter);
+			if (i % 9 == 0 && text.size() > 20) {
+				const size_t beg = gp.PrevCodePoint(index / 2 + 1), end = gp.NextCodePoint(gp.NextCodePoint(beg));
+				gp.Erase(cbegin(gp) + beg, cbegin(gp) + end);
+				text.erase(beg, end - beg);
+			}
+		}
+
+		vector<size_t> starts;
+		for (size_t i = 0; i < text.size(); ++i)
+			if ((text[i] & 0xC0) != 0x80)
+				starts.push_back(i);
+		EXPECT_EQ(gp.HasCodePointIndex(), indexed);
+		ASSERT_EQ(gp.CodePointCount(), starts.size());
+		EXPECT_TRUE(gp.IsValidUtf8());
+		for (size_t n = 0; n < starts.size(); n += 7) {
+			EXPECT_EQ(gp.OffsetOfCodePoint(n), starts[n]) << "Code point offset mistake, code point " << n;
+			EXPECT_EQ(gp.CodePointsBefore(starts[n]), n);
+			EXPECT_EQ(gp.NextCodePoint(starts[n]), n + 1 < starts.size() ? starts[n + 1] : text.size());
+			EXPECT_EQ(gp.PrevCodePoint(starts[n]), n == 0 ? 0 : starts[n - 1]);
+		}
+		EXPECT_EQ(gp.OffsetOfCodePoint(starts.size()), text.size());
+		EXPECT_EQ(gp.CodePointsBefore(text.size()), starts.size());
+		EXPECT_THROW(gp.OffsetOfCodePoint(starts.size() + 1), out_of_range);
+		GapBuffer copy(gp);
+		EXPECT_EQ(copy.CodePointCount(), starts.size());
+	}
+
+	//The gap cuts the code point, then the sequences are broken
+	const string clef = "x\xF0\x9D\x84\x9Ey";
+	for (size_t gap = 0; gap <= clef.size(); ++gap) {
+		GapBuffer gp;
+		gp.Insert(0, begin(clef), end(clef));
+		gp.Insert(gap, 'z');
+		gp.Erase(cbegin(gp) + gap);
+		EXPECT_TRUE(gp.IsValidUtf8()) << "Gap " << gap;
+		EXPECT_EQ(gp.NextCodePoint(1), 5);
+		EXPECT_EQ(gp.PrevCodePoint(5), 1);
+		gp.Erase(cbegin(gp) + 3);
+		EXPECT_FALSE(gp.IsValidUtf8()) << "Cut sequence isn't found, gap " << gap;
+	}
+	for (const string broken : { "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\x80", "ab\xE2\x82" }) {
+		GapBuffer gp;
+		gp.Insert(0, broken);
+		EXPECT_FALSE(gp.IsValidUtf8()) << "Ill-formed sequence is accepted.";
+	}
+}
+
+TEST_F(GapBufferTest, LineIndexAfterCopyAndClear) {
+	gp_first.EnableLineIndex();
+	gp_first.Insert(2, '\n');
+	GapBuffer copy(gp_first);
+	EXPECT_TRUE(copy.HasLineIndex());
+	EXPECT_EQ(copy.LineColOf(4), (pair<size_t, size_t>(1, 1)));
+	GapBuffer moved(std::move(copy));
+	EXPECT_EQ(moved.LineCount(), 2);
+	EXPECT_EQ(moved.OffsetOfLine(1), 3);
+	moved.Clear();
+	EXPECT_EQ(moved.LineCount(), 1);
+}
+
+TEST_F(GapBufferTest, BatchEdit) {
+	string text;
+	for (int i = 0; i < 2'000; ++i)
+		text += "word" + to_string(i) + ' ';
+	GapBuffer gp;
+	gp.Insert(0, begin(text), end(text));
+	gp.Insert(text.size() / 3, '#');
+	text.insert(text.size() / 3, 1, '#');
+	gp.EnableLineIndex();
+
+	//Inserts, removals, replacements, adjacent edits and both ends of the data
+	const string caret = "|\n";
+	vector<GapBuffer::edit> edits;
+	vector<size_t> carets;
+	string expected;
+	size_t in = 0;
+	for (size_t offset = 0; offset <= text.size(); offset += 97) {
+		const size_t erase_count = offset % 3 == 0 ? 0 : min<size_t>(offset % 5, text.size() - offset);
+		edits.push_back({ offset, erase_count, caret });
+		expected += text.substr(in, offset - in) + caret;
+		carets.push_back(expected.size());
+		in = offset + erase_count;
+	}
+	edits.push_back({ text.size(), 0, caret });
+	expected += text.substr(in) + caret;
+	carets.push_back(expected.size());
+
+	EXPECT_EQ(gp.BatchEdit(edits), carets) << "Carets are not adjusted.";
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), expected);
+	EXPECT_EQ(gp.LineCount(), edits.size() + 1);
+	EXPECT_EQ(gp.getGapPos().first, expected.size()) << "Gap isn't after the last edit.";
+	EXPECT_TRUE(gp.BatchEdit({}).empty());
+}
+
+TEST(BasicGapBufferTest, ReplaceAll) {
+	string text;
+	for (int i = 0; i < 3'000; ++i)
+		text += "key" + to_string(i % 17) + "=value;";
+	GapBuffer gp;
+	gp.Insert(0, begin(text), end(text));
+	gp.Insert(text.find("value", 100) + 2, '#');
+	text.insert(text.find("value", 100) + 2, 1, '#');
+	const size_t gap = text.find("value", 5'000) + 3;
+	gp.Insert(gap, 'x');
+	gp.Erase(cbegin(gp) + gap);
+	gp.EnableUndo();
+
+	//The pattern crosses the gap in one match and is cut by the '#' in another one
+	string expected = text;
+	size_t count = 0;
+	for (size_t pos = expected.find("value"); pos != string::npos; pos = expected.find("value", pos + 2), ++count)
+		expected.replace(pos, 5, "v2");
+	const auto report = gp.ReplaceAll(string("value"), string("v2"));
+	EXPECT_EQ(report.count, count);
+	EXPECT_GT(report.megabytes_per_second, 0.0);
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), expected);
+	EXPECT_EQ(gp.getGapPos().first, expected.rfind("v2") + 2) << "Gap isn't after the last replacement.";
+	EXPECT_TRUE(gp.Undo());
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text) << "Replacement isn't undone at once.";
+
+	const regex pattern("key(\\d+)=");
+	const string format = "$1:";
+	const auto regex_report = gp.ReplaceAll(pattern, format);
+	EXPECT_EQ(regex_report.count, 3'000);
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), regex_replace(text, pattern, format));
+	EXPECT_EQ(gp.ReplaceAll(string("absent"), string("x")).count, 0);
+	EXPECT_EQ(gp.ReplaceAll(string(), string("x")).count, 0);
+}
+
+TEST(BasicGapBufferTest, ReplaceAllByOwnText) {
+	//The replacement and the pattern are taken from the inline storage
+	GapBuffer gp;
+	const string word = "ab-cd-";
+	gp.Insert(0, begin(word), end(word));
+	const auto own = gp.ContiguousView();
+	ASSERT_TRUE(gp.IsInline());
+	EXPECT_EQ(gp.ReplaceAll(own.subspan(2, 1), own.subspan(1, 2)).count, 2);
+	EXPECT_TRUE(gp.IsInline());
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "abb-cdb-") << "Replacement is read after it's overwritten.";
+}
+
+TEST_F(GapBufferTest, BatchEditSmallAndIncorrect) {
+	GapBuffer gp;
+	const string word = "inline";
+	gp.Insert(0, begin(word), end(word));
+	gp.Insert(2, '-');
+	const string text = "AB";
+	const vector<GapBuffer::edit> edits = { { 0, 1, text }, { 3, 2, {} }, { 7, 0, text } };
+	EXPECT_EQ(gp.BatchEdit(edits), (vector<size_t>{ 2, 4, 8 }));
+	EXPECT_TRUE(gp.IsInline());
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "ABn-neAB");
+
+	EXPECT_THROW(gp.BatchEdit(vector<GapBuffer::edit>{ { 3, 2, {} }, { 4, 0, text } }), invalid_argument) << "Overlapped edits are applied.";
+	EXPECT_THROW(gp.BatchEdit(vector<GapBuffer::edit>{ { 5, 0, {} }, { 1, 0, text } }), invalid_argument) << "Unsorted edits are applied.";
+	EXPECT_THROW(gp.BatchEdit(vector<GapBuffer::edit>{ { 7, 2, {} } }), invalid_argument);
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "ABn-neAB");
+}
+
+//Element whose copy throws when the budget of copies is spent
+struct fragile {
+	static inline int copies_left = -1;
+	string text;
+	fragile() = default;
+	fragile(const char* text) : text(text) { }
+	fragile(const fragile& other) : text(other.text) { Spend(); }
+	fragile(fragile&&) noexcept = default;
+	fragile& operator=(const fragile& other) { Spend(); text = other.text; return *this; }
+	fragile& operator=(fragile&&) noexcept = default;
+	bool operator==(const fragile&) const = default;
+	static void Spend() {
+		if (copies_left == 0)
+			throw runtime_error("Copy budget is spent.");
+		if (copies_left > 0)
+			--copies_left;
+	}
+};
+
+TEST(BasicGapBufferTest, BatchEditOwnText) {
+	//The texts are taken from the inline storage which is rebuilt in place
+	GapBuffer gp;
+	const string word = "abcdef";
+	gp.Insert(0, begin(word), end(word));
+	gp.EnableUndo();
+	const auto own = gp.ContiguousView();
+	ASSERT_TRUE(gp.IsInline());
+	const vector<GapBuffer::edit> edits = { { 0, 2, own.subspan(4, 2) }, { 4, 0, own.subspan(0, 3) } };
+	EXPECT_EQ(gp.BatchEdit(edits), (vector<size_t>{ 2, 7 }));
+	const string edited = "efcdabcef";
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), edited) << "Own text is read after it's overwritten.";
+	gp.Undo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), word);
+	gp.Redo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), edited);
+
+	//The throwing copy leaves the elements and the history as they were
+	basic_gap_buffer<fragile> elements;
+	const vector<fragile> values = { "alpha", "beta", "gamma", "delta", "epsilon" };
+	elements.Insert(0, begin(values), end(values));
+	elements.EnableUndo();
+	const vector<fragile> inserted = { "one", "two" };
+	const vector<basic_gap_buffer<fragile>::edit> changes = { { 1, 1, inserted }, { 4, 1, inserted } };
+	fragile::copies_left = 7;
+	EXPECT_THROW(elements.BatchEdit(changes), runtime_error);
+	fragile::copies_left = -1;
+	EXPECT_TRUE(equal(cbegin(elements), cend(elements), begin(values), end(values))) << "Elements are moved out by the failed edit.";
+	EXPECT_FALSE(elements.CanUndo()) << "Failed edit is recorded.";
+	elements.BatchEdit(changes);
+	const vector<fragile> expected = { "alpha", "one", "two", "gamma", "delta", "one", "two" };
+	EXPECT_TRUE(equal(cbegin(elements), cend(elements), begin(expected), end(expected)));
+}
+
+TEST_F(GapBufferTest, GrowthPolicy) {
+	GapBuffer::growth_policy policy;
+	policy.factor = 1.5;
+	policy.min_gap = 4;
+	policy.shrink_threshold = 0.5;
+	gp_fourth.SetGrowthPolicy(policy);
+	gp_fourth.Insert(0, 'x');
+	EXPECT_EQ(gp_fourth.StorageSize(), 25'000) << "Gap isn't full, the storage mustn't grow.";
+
+	gp_fourth.Erase(cbegin(gp_fourth), cbegin(gp_fourth) + 15'000);
+	EXPECT_EQ(gp_fourth.Size(), 501);
+	EXPECT_LT(gp_fourth.StorageSize(), 1'000) << "Sparse storage should be shrunk.";
+	EXPECT_TRUE(all_of(begin(gp_fourth) + 1, end(gp_fourth), [](char c) { return c == '+'; }));
+
+	policy.factor = 0.5;
+	EXPECT_THROW(gp_fourth.SetGrowthPolicy(policy), invalid_argument);
+}
+
+//The log tail and the header counter are edited in turn, the edits at the tail shift the data
+//and the gap stays at the header. Both buffers must give the same data, lines and undo.
+TEST(BasicGapBufferTest, AdaptivePlacement) {
+	string text;
+	for (size_t i = 0; i < 20'000; ++i)
+		text += "line " + to_string(i) + '\n';
+	GapBuffer adaptive(begin(text), end(text));
+	GapBuffer::growth_policy policy;
+	policy.adaptive = true;
+	adaptive.SetGrowthPolicy(policy);
+	GapBuffer eager(begin(text), end(text));
+	for (GapBuffer* gp : { &adaptive, &eager }) {
+		gp->EnableLineIndex();
+		gp->EnableUndo();
+		gp->ResetStats();
+	}
+
+	string model = text;
+	for (size_t i = 0; i < 200; ++i) {
+		const string entry = "entry " + to_string(i) + '\n';
+		const char digit = static_cast<char>('0' + i % 10);
+		for (GapBuffer* gp : { &adaptive, &eager }) {
+			gp->Insert(gp->Size(), entry);
+			gp->Erase(cbegin(*gp) + 5);
+			gp->Insert(5, digit);
+			if (i % 50 == 49)
+				gp->Erase(cbegin(*gp) + gp->Size() - 7, cbegin(*gp) + gp->Size() - 1);
+		}
+		model += entry;
+		model[5] = digit;
+		if (i % 50 == 49)
+			model.erase(model.size() - 7, 6);
+	}
+	EXPECT_EQ(string(cbegin(adaptive), cend(adaptive)), model);
+	EXPECT_TRUE(adaptive == eager || string(cbegin(adaptive), cend(adaptive)) == string(cbegin(eager), cend(eager)));
+	EXPECT_EQ(adaptive.LineCount(), eager.LineCount());
+	EXPECT_EQ(adaptive.OffsetOfLine(20'100), eager.OffsetOfLine(20'100));
+#if GAPBUFFER_STATS
+	const gap_stats stats = adaptive.Stats();
+	EXPECT_GT(stats.shifts, 0) << "Ping-pong isn't detected.";
+	const gap_stats eager_stats = eager.Stats();
+	EXPECT_LT(stats.bytes_moved_left + stats.bytes_moved_right + stats.bytes_shifted, (eager_stats.bytes_moved_left + eager_stats.bytes_moved_right) * 2 / 3);
+#endif
+
+	while (adaptive.Undo())
+		;
+	EXPECT_EQ(string(cbegin(adaptive), cend(adaptive)), text);
+	EXPECT_EQ(adaptive.LineCount(), 20'001);
+}
+
+//Backspaces, deletes and the range over the gap only change the gap bounds, the range
+//before the gap moves the data between them, the erased elements aren't moved
+TEST(BasicGapBufferTest, EraseJoinsGap) {
+	string model;
+	for (size_t i = 0; i < 1'000; ++i)
+		model += i % 40 == 39 ? '\n' : static_cast<char>('a' + i % 26);
+	GapBuffer gp(begin(model), end(model));
+	gp.EnableLineIndex();
+	gp.Insert(500, 'y');
+	model.insert(500, 1, 'y');
+	gp.ResetStats();
+
+	for (size_t i = 0; i < 10; ++i) {
+		gp.Erase(cbegin(gp) + 500 - i);
+		model.erase(500 - i, 1);
+	}
+	for (size_t i = 0; i < 5; ++i) {
+		gp.Erase(begin(gp) + 491);
+		model.erase(491, 1);
+	}
+	gp.Erase(cbegin(gp) + 480, cbegin(gp) + 500);
+	model.erase(480, 20);
+	EXPECT_EQ(gp.getGapPos().first, 480);
+#if GAPBUFFER_STATS
+	EXPECT_EQ(gp.Stats().gap_moves, 0) << "Erase at the gap moves it.";
+#endif
+
+	gp.Erase(begin(gp) + 100, begin(gp) + 110);
+	model.erase(100, 10);
+	EXPECT_EQ(gp.getGapPos().first, 100);
+#if GAPBUFFER_STATS
+	EXPECT_EQ(gp.Stats().bytes_moved_left, 480 - 110) << "Erased elements are moved.";
+#endif
+
+	const auto it = gp.Erase(cbegin(gp) + 200);
+	model.erase(200, 1);
+	EXPECT_EQ(it, begin(gp) + 200);
+	EXPECT_EQ(*it, model[200]);
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), model);
+	EXPECT_EQ(gp.LineCount(), static_cast<size_t>(count(begin(model), end(model), '\n')) + 1);
+	EXPECT_EQ(gp.Erase(cbegin(gp) + 10, cend(gp)), end(gp));
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), model.substr(0, 10));
+}
+
+//The adaptive gap of the big buffer is 1/16 of the data instead of the data size
+TEST(BasicGapBufferTest, AdaptiveGrowth) {
+	GapBuffer gp;
+	GapBuffer::growth_policy policy;
+	policy.adaptive = true;
+	gp.SetGrowthPolicy(policy);
+	gp.Insert(0, 1 << 20, 'x');
+	EXPECT_EQ(gp.StorageSize(), (1 << 20) + policy.min_gap) << "The first insert isn't the rate.";
+	gp.Insert(1 << 19, 17, 'y');
+	EXPECT_EQ(gp.StorageSize(), (1 << 20) + (1 << 16));
+	EXPECT_EQ(gp.getGapPos().first, (1 << 19) + 17) << "The grown gap isn't placed at the insert.";
+
+	for (size_t i = 0; i < (1 << 16); ++i)
+		gp.Insert((1 << 19) + 17 + i, 'z');
+	EXPECT_LE(gp.StorageSize(), gp.Size() + (1 << 17) + 1) << "The gap isn't sized by the inserts.";
+	EXPECT_EQ(gp.Count('z'), 1 << 16);
+}
+
 TEST_F(GapBufferTest, 1_Erase) {
 	auto cbeg = cbegin(gp_first);
 	GapBuffer::iterator next = gp_first.Erase(cbeg + 3);
@@ -159,7 +748,6 @@ TEST_F(GapBufferTest, 3_Erase) {
 
 TEST_F(GapBufferTest, 4_Erase) {
 	gp_fourth.Erase(cbegin(gp_fourth), cend(gp_fourth));
-	auto dist2 = gp_fourth.GapSize();
 	EXPECT_EQ(gp_fourth.GapSize(), 25'000) << "Container should be empty";
 	EXPECT_EQ(cbegin(gp_fourth), cend(gp_fourth)) << "Erase function mistake";
 }
@@ -277,4 +865,747 @@ TEST_F(ConstIteratorTest, CompoundOperators) {
 	EXPECT_EQ(*(beg_third += 1), '9');
 	EXPECT_THROW(*(beg_third += 2), out_of_range);
 	EXPECT_EQ(*(end_fourth -= 10'001), '+');
-}
\ No newline at end of file
+}
+
+TEST_F(ConstIteratorTest, BoundsAcrossGap) {
+	EXPECT_THROW(beg_first + 7, out_of_range) << "Shift over the gap past the end isn't detected.";
+	EXPECT_THROW(end_first - 7, out_of_range) << "Shift over the gap before the begin isn't detected.";
+	EXPECT_THROW(*end_first, out_of_range) << "end() can't be dereferenced.";
+	EXPECT_EQ(*(beg_first + 3), 'd');
+	EXPECT_EQ(*(beg_first + 4), 'g');
+	EXPECT_EQ((end_first - 2) - beg_first, 4);
+	EXPECT_EQ(beg_fourth[10'000], '+');
+}
+
+TEST_F(ConstIteratorTest, WalkSkipsGap) {
+	string walked;
+	for (auto it = beg_first; it != end_first; ++it)
+		walked += *it;
+	EXPECT_EQ(walked, "abcdgh");
+
+	string reversed;
+	for (auto it = end_first; it != beg_first;)
+		reversed += *--it;
+	EXPECT_EQ(reversed, "hgdcba");
+}
+
+//16 bytes styled cell of a terminal emulator
+struct Cell {
+	char32_t glyph;
+	uint32_t foreground;
+	uint32_t background;
+	uint32_t attributes;
+	bool operator==(const Cell&) const = default;
+};
+
+TEST(BasicGapBufferTest, CodePoints) {
+	basic_gap_buffer<char32_t> gp;
+	u32string text = U"\u041f\u0440\u0438\u0432\u0435\u0442";
+	gp.Insert(0, begin(text), end(text));
+	gp.Insert(3, U'\U0001F600');
+	gp.Insert(0, 2, U'>');
+	u32string to_compare = U">>\u041f\u0440\u0438\U0001F600\u0432\u0435\u0442";
+	EXPECT_EQ(gp.Size(), to_compare.size());
+	EXPECT_TRUE(equal(cbegin(gp), cend(gp), begin(to_compare))) << "char32_t buffer mistake.";
+}
+
+TEST(BasicGapBufferTest, TriviallyCopyableRecords) {
+	static_assert(sizeof(Cell) == 16);
+	basic_gap_buffer<Cell> gp;
+	vector<Cell> cells;
+	for (uint32_t i = 0; i < 100; ++i)
+		cells.push_back({ U'a' + i % 26, i, 0, 0 });
+	gp.Insert(0, span<const Cell>(cells));
+	gp.Insert(50, Cell{ U'*', 1, 2, 3 });
+	gp.Erase(cbegin(gp) + 10, cbegin(gp) + 20);
+	cells.insert(begin(cells) + 50, Cell{ U'*', 1, 2, 3 });
+	cells.erase(begin(cells) + 10, begin(cells) + 20);
+	EXPECT_EQ(gp.Size(), cells.size());
+	EXPECT_TRUE(equal(cbegin(gp), cend(gp), begin(cells))) << "Trivially copyable buffer mistake.";
+	EXPECT_EQ((cbegin(gp) + 40)->glyph, U'*');
+}
+
+TEST(BasicGapBufferTest, NonTrivialElements) {
+	basic_gap_buffer<string> gp;
+	vector<string> words = { "alpha", "beta", "gamma", "delta" };
+	gp.Insert(0, begin(words), end(words));
+	gp.Insert(1, string("inserted"));
+	gp.Insert(4, string("moved"));
+	gp.Erase(cbegin(gp));
+	vector<string> to_compare = { "inserted", "beta", "gamma", "moved", "delta" };
+	EXPECT_EQ(gp.Size(), to_compare.size());
+	EXPECT_TRUE(equal(cbegin(gp), cend(gp), begin(to_compare))) << "Non trivial elements are broken by the gap move.";
+}
+
+//Memory resource which counts the allocations passed to the upstream
+struct CountingResource : pmr::memory_resource {
+	size_t allocations = 0;
+	void* do_allocate(size_t bytes, size_t align) override { ++allocations; return pmr::new_delete_resource()->allocate(bytes, align); }
+	void do_deallocate(void* p, size_t bytes, size_t align) override { pmr::new_delete_resource()->deallocate(p, bytes, align); }
+	bool do_is_equal(const pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+TEST(BasicGapBufferTest, SmallBufferIsInline) {
+	CountingResource counter;
+	PmrGapBuffer gp(&counter);
+	const string word = "small";
+	gp.Insert(0, begin(word), end(word));
+	EXPECT_TRUE(gp.IsInline());
+	gp.Clear();
+	EXPECT_TRUE(gp.IsInline());
+	EXPECT_EQ(counter.allocations, 0) << "Small buffer allocated the storage.";
+
+	const string text(100, 'x');
+	gp.Insert(0, begin(text), end(text));
+	EXPECT_FALSE(gp.IsInline());
+	EXPECT_EQ(counter.allocations, 1);
+	EXPECT_TRUE(equal(cbegin(gp), cend(gp), begin(text)));
+}
+
+TEST(BasicGapBufferTest, SideStateOnUse) {
+	CountingResource counter;
+	PmrGapBuffer gp(&counter);
+	const string text = "one\ntwo";
+	gp.Insert(0, begin(text), end(text));
+	gp.Erase(cbegin(gp));
+	EXPECT_EQ(counter.allocations, 0) << "Plain buffer allocated the side state.";
+
+	gp.EnableLineIndex();
+	EXPECT_EQ(counter.allocations, 1);
+	EXPECT_TRUE(gp.HasLineIndex());
+	PmrGapBuffer copy(gp);
+	EXPECT_TRUE(copy.HasLineIndex());
+	EXPECT_EQ(copy.OffsetOfLine(1), 3);
+	PmrGapBuffer moved(std::move(gp));
+	EXPECT_TRUE(moved.HasLineIndex());
+	EXPECT_FALSE(gp.HasLineIndex());
+	EXPECT_EQ(moved.LineCount(), 2);
+}
+
+//Allocations of the global operator new, the test binary replaces it to count them
+static atomic<size_t> global_allocations = 0;
+
+void* operator new(size_t size) {
+	++global_allocations;
+	if (void* p = malloc(size == 0 ? 1 : size))
+		return p;
+	throw bad_alloc();
+}
+//GCC sees free of the inlined new as a mismatch, but the replaced new is malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+TEST(BasicGapBufferTest, UndoJournalOnUse) {
+	//The arena has no upstream, so every allocation of the buffer is in it or global
+	alignas(max_align_t) char arena_storage[4096];
+	pmr::monotonic_buffer_resource arena(arena_storage, sizeof(arena_storage), pmr::null_memory_resource());
+	const size_t before = global_allocations;
+	PmrGapBuffer gp(&arena);
+	gp.SetGrowthPolicy({ 2.0, 16, 0.0, true });
+	gp.Insert(0, 'x');
+	gp.Insert(1, 'y');
+	gp.Erase(cbegin(gp));
+	const size_t allocations = global_allocations - before;
+	EXPECT_EQ(allocations, 0) << "Buffer without undo allocated the journal.";
+	EXPECT_FALSE(gp.HasUndo());
+	EXPECT_EQ(gp.UndoMemory(), 0);
+
+	gp.EnableUndo();
+	gp.Insert(0, 'z');
+	EXPECT_TRUE(gp.Undo());
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "y");
+	gp.DisableUndo();
+	EXPECT_FALSE(gp.HasUndo());
+	EXPECT_FALSE(gp.CanRedo());
+}
+
+TEST(BasicGapBufferTest, MoveInlineBuffer) {
+	GapBuffer gp;
+	const string word = "inline";
+	gp.Insert(0, begin(word), end(word));
+	gp.Insert(3, 'X');
+	GapBuffer moved(std::move(gp));
+	EXPECT_TRUE(moved.IsInline());
+	EXPECT_EQ(gp.Size(), 0);
+	EXPECT_EQ(string(cbegin(moved), cend(moved)), "inlXine");
+	moved.Insert(0, '>');
+	EXPECT_EQ(string(cbegin(moved), cend(moved)), ">inlXine") << "Moved inline buffer points to the source storage.";
+}
+
+TEST(BasicGapBufferTest, ArenaAllocator) {
+	pmr::monotonic_buffer_resource arena;
+	pmr::vector<PmrGapBuffer> buffers(&arena);
+	for (int i = 0; i < 100; ++i) {
+		buffers.emplace_back();
+		const string line = "line " + to_string(i) + string(40, '.');
+		buffers.back().Insert(0, begin(line), end(line));
+	}
+	for (const auto& gp : buffers)
+		EXPECT_EQ(gp.GetAllocator().resource(), &arena) << "Buffer doesn't use the container arena.";
+	EXPECT_EQ(string(cbegin(buffers[42]), cbegin(buffers[42]) + 7), "line 42");
+
+	PmrGapBuffer copy(buffers[7], pmr::new_delete_resource());
+	EXPECT_EQ(copy, buffers[7]);
+	EXPECT_EQ(copy.GetAllocator().resource(), pmr::new_delete_resource());
+}
+
+TEST(KernelsTest, LevelsAgree) {
+	string text(5'000, 'a');
+	for (size_t i = 0; i < text.size(); i += 1 + i % 37)
+		text[i] = '\n';
+	string other = text;
+	other[4'321] = 'z';
+	const char* beg = text.data();
+	for (simd_level level : { simd_level::portable, simd_level::sse2, simd_level::avx2 }) {
+		const byte_kernels& kernels = ByteKernels(level);
+		//Unaligned starts and short tails
+		for (size_t offset : { 0, 1, 7, 31 }) {
+			for (size_t len : { 0, 1, 15, 33, 100, 4'999 - 31 }) {
+				const char* b = beg + offset;
+				EXPECT_EQ(kernels.count_byte(b, b + len, '\n'), static_cast<size_t>(count(b, b + len, '\n')));
+				EXPECT_EQ(kernels.find_byte(b, b + len, 'a'), find(b, b + len, 'a'));
+				EXPECT_EQ(kernels.find_byte(b, b + len, 'z'), b + len);
+				for (size_t size : { 0, 1, 2, 3, 17, 40 }) {
+					const string needle = text.substr(2'000 + size, size);
+					EXPECT_EQ(kernels.find_bytes(b, b + len, needle.data(), size), search(b, b + len, begin(needle), end(needle)));
+				}
+			}
+		}
+		string utf8;
+		for (size_t i = 0; utf8.size() < 300; ++i)
+			utf8 += i % 7 == 0 ? "\xE2\x82\xAC" : i % 5 == 0 ? "\xC3\xA9" : "a";
+		for (size_t len = 0; len <= utf8.size(); ++len) {
+			const char* b = utf8.data();
+			EXPECT_EQ(kernels.count_code_points(b, b + len), static_cast<size_t>(count_if(b, b + len, [](char c) { return (c & 0xC0) != 0x80; })));
+			EXPECT_EQ(kernels.validate_utf8(b, b + len), ByteKernels(simd_level::portable).validate_utf8(b, b + len)) << "Validation mistake, length " << len;
+		}
+		EXPECT_EQ(kernels.mismatch(text.data(), other.data(), text.size()), 4'321) << "Mismatch kernel mistake.";
+		EXPECT_EQ(kernels.mismatch(text.data(), text.data(), text.size()), text.size());
+		const string lines(100'003, '\n');
+		EXPECT_EQ(kernels.count_byte(lines.data(), lines.data() + lines.size(), '\n'), lines.size()) << "Byte counters overflow.";
+	}
+}
+
+//Writes the text to the file in the temporary directory and removes it in the end
+class TempFile {
+public:
+	explicit TempFile(const string& text) : path(filesystem::temp_directory_path() / ("gapbuffer_" + to_string(reinterpret_cast<uintptr_t>(this)) + ".txt")) {
+		ofstream(path, ios::binary) << text;
+	}
+	~TempFile() { filesystem::remove(path); }
+
+	filesystem::path path;
+};
+
+TEST(BasicGapBufferTest, FromFile) {
+	string text;
+	for (int i = 0; i < 1'000; ++i)
+		text += "line " + to_string(i) + '\n';
+	TempFile file(text);
+
+	GapBuffer gp = GapBuffer::FromFile(file.path);
+	EXPECT_TRUE(gp.IsMapped());
+	EXPECT_EQ(gp.Size(), text.size());
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text);
+	EXPECT_EQ(gp.Find('9'), text.find('9'));
+	EXPECT_EQ(gp.LineCount(), 1'001);
+
+	GapBuffer copy(gp);
+	const string copy_text = text;
+	EXPECT_FALSE(copy.IsMapped());
+	EXPECT_EQ(copy, gp);
+
+	//Removal moves the gap into the data, the file is copied first
+	gp.Erase(cbegin(gp) + 5, cbegin(gp) + 7);
+	text.erase(5, 2);
+	EXPECT_FALSE(gp.IsMapped()) << "Edit is done in the mapping.";
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text);
+
+	GapBuffer inserted = GapBuffer::FromFile(file.path);
+	inserted.Insert(0, '>');
+	EXPECT_FALSE(inserted.IsMapped());
+	EXPECT_EQ(*cbegin(inserted), '>');
+	EXPECT_EQ(inserted.Size(), copy.Size() + 1);
+
+	//Writes through the iterators go to the copy, the file isn't changed
+	GapBuffer written = GapBuffer::FromFile(file.path);
+	*begin(written) = 'L';
+	*(end(written) - 1) = '.';
+	EXPECT_FALSE(written.IsMapped());
+	EXPECT_EQ(string(cbegin(written), cend(written)), 'L' + copy_text.substr(1, copy_text.size() - 2) + '.');
+	EXPECT_EQ(GapBuffer::FromFile(file.path), copy);
+
+	//The erase at the end joins the gap, the next insert writes to it
+	GapBuffer tail = GapBuffer::FromFile(file.path);
+	tail.Erase(cend(tail) - 1);
+	EXPECT_FALSE(tail.IsMapped());
+	tail.Insert(tail.Size(), 'X');
+	EXPECT_EQ(string(cbegin(tail), cend(tail)), copy_text.substr(0, copy_text.size() - 1) + 'X');
+}
+
+TEST(BasicGapBufferTest, FromFileErrors) {
+	TempFile empty("");
+	GapBuffer gp = GapBuffer::FromFile(empty.path);
+	EXPECT_FALSE(gp.IsMapped());
+	EXPECT_EQ(gp.Size(), 0);
+	EXPECT_THROW(GapBuffer::FromFile(empty.path.string() + ".missing"), system_error);
+}
+
+TEST(BasicGapBufferTest, SelfInsert) {
+	string text = "the text which doesn't fit inline storage";
+	GapBuffer gp;
+	gp.Insert(0, begin(text), end(text));
+	gp.Insert(gp.Size(), gp.Segments().first);
+	text += text;
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text) << "Span of the buffer is read after the reallocation.";
+
+	gp.Insert(3, cbegin(gp), cbegin(gp) + 4);
+	text.insert(3, text.substr(0, 4));
+	gp.Insert(0, cbegin(gp) + 10, cend(gp));
+	text.insert(0, text.substr(10));
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text) << "Iterators of the buffer are read after the gap move.";
+
+	const auto [first, second] = gp.Segments();
+	gp.Insert(1, first.data() + 1, first.data() + 3);
+	text.insert(1, text.substr(1, 2));
+	gp.Insert(0, 3, *(cbegin(gp) + 2));
+	text.insert(0, 3, text[2]);
+	gp.Insert(gp.Size(), *cbegin(gp));
+	text += text[0];
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text) << "Element of the buffer is read after the gap move.";
+}
+
+TEST(BasicGapBufferTest, SetNewData) {
+	GapBuffer gp;
+	gp.EnableUndo();
+	gp.EnableLineIndex();
+	gp.Insert(0, 'x');
+	gp.setNewData("a\nb**\nc", 3, 5);
+	EXPECT_EQ(gp.StorageSize(), 7);
+	EXPECT_TRUE(IsGapPairEqual(gp.getGapPos(), make_pair(3, 5)));
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "a\nb\nc");
+	EXPECT_EQ(gp.getGapData(), vector<char>({ 'a', '\n', 'b', '*', '*', '\n', 'c' }));
+	EXPECT_EQ(gp.LineCount(), 3) << "Line index isn't rebuilt.";
+	EXPECT_FALSE(gp.CanUndo()) << "History of the old data is kept.";
+
+	const string text(100, 'y');
+	gp.setNewData(text, 100, 100);
+	EXPECT_FALSE(gp.IsInline());
+	EXPECT_EQ(gp.Size(), 100);
+	EXPECT_THROW(gp.setNewData("abc", 2, 1), invalid_argument);
+	EXPECT_THROW(gp.setNewData("abc", 1, 4), invalid_argument);
+	EXPECT_EQ(gp.Size(), 100) << "Rejected data changed the buffer.";
+}
+
+TEST(BasicGapBufferTest, SinglePassIterators) {
+	istringstream stream("read once");
+	GapBuffer gp{ istreambuf_iterator<char>(stream), istreambuf_iterator<char>() };
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "read once");
+	istringstream more(" and again");
+	gp.Insert(gp.Size(), istreambuf_iterator<char>(more), istreambuf_iterator<char>());
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "read once and again");
+}
+
+string ReadFile(const filesystem::path& path) {
+	ifstream in(path, ios::binary);
+	return { istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+}
+
+TEST(BasicGapBufferTest, SaveTo) {
+	string text(100'000, 'x');
+	for (size_t i = 0; i < text.size(); i += 100)
+		text[i] = '\n';
+	GapBuffer gp;
+	gp.Insert(0, begin(text), end(text));
+	gp.Insert(50'000, '*');
+	text.insert(begin(text) + 50'000, '*');
+	ASSERT_FALSE(gp.IsGapEmpty());
+
+	TempFile file("old content which is longer than nothing");
+	for (save_sync sync : { save_sync::none, save_sync::data, save_sync::range, save_sync::direct }) {
+		for (bool atomic : { true, false }) {
+			gp.SaveTo(file.path, { atomic, sync });
+			EXPECT_EQ(ReadFile(file.path), text) << "Saved file mistake, sync mode " << static_cast<int>(sync) << ", atomic " << atomic;
+		}
+	}
+
+	//The mapped buffer is saved over its own file
+	GapBuffer mapped = GapBuffer::FromFile(file.path);
+	mapped.SaveTo(file.path, { false, save_sync::none });
+	mapped.SaveTo(file.path);
+	EXPECT_EQ(ReadFile(file.path), text);
+	EXPECT_EQ(string(cbegin(mapped), cend(mapped)), text);
+	EXPECT_THROW(gp.SaveTo(file.path / "not_a_directory"), system_error);
+}
+
+TEST(BasicGapBufferTest, SaveOverMappedFile) {
+	const string text(10'000, 'm');
+	TempFile file(text);
+	GapBuffer editor = GapBuffer::FromFile(file.path);
+	GapBuffer reader = GapBuffer::FromFile(file.path);
+	editor.Erase(cbegin(editor) + 100, cend(editor));
+	editor.SaveTo(file.path, { false, save_sync::none });
+	EXPECT_EQ(ReadFile(file.path), text.substr(0, 100));
+	EXPECT_TRUE(reader.IsMapped());
+	EXPECT_EQ(string(cbegin(reader), cend(reader)), text) << "In-place save changed the other mapping.";
+
+	//The mappings are closed, the file is written in place
+	reader = GapBuffer();
+	editor.Insert(0, 'x');
+	editor.SaveTo(file.path, { false, save_sync::none });
+	EXPECT_EQ(ReadFile(file.path), 'x' + text.substr(0, 100));
+}
+
+TEST(BasicGapBufferTest, UndoRedo) {
+	GapBuffer gp;
+	gp.EnableUndo();
+	gp.EnableLineIndex();
+	EXPECT_FALSE(gp.Undo());
+	const string typed = "hello\nworld";
+	for (size_t i = 0; i < typed.size(); ++i)
+		gp.Insert(i, typed[i]);
+	const string pasted = " pasted";
+	gp.Insert(5, begin(pasted), end(pasted));
+	gp.Erase(cbegin(gp) + 1, cbegin(gp) + 3);
+	for (size_t i = 0; i < 3; ++i)
+		gp.Erase(cbegin(gp) + gp.Size() - 1);               //Backspace
+	gp.Erase(cbegin(gp));                                  //Delete
+	gp.Erase(cbegin(gp));
+	const vector<string> states = { "", typed, "hello pasted\nworld", "hlo pasted\nworld", "hlo pasted\nwo", "o pasted\nwo" };
+
+	for (size_t i = states.size() - 1; i > 0; --i) {
+		EXPECT_EQ(string(cbegin(gp), cend(gp)), states[i]);
+		EXPECT_TRUE(gp.Undo());
+	}
+	EXPECT_EQ(gp.Size(), 0) << "Typing isn't coalesced.";
+	EXPECT_FALSE(gp.Undo());
+	EXPECT_EQ(gp.LineCount(), 1);
+	for (size_t i = 1; i < states.size(); ++i) {
+		EXPECT_TRUE(gp.Redo());
+		EXPECT_EQ(string(cbegin(gp), cend(gp)), states[i]);
+	}
+	EXPECT_FALSE(gp.Redo());
+	EXPECT_EQ(gp.LineCount(), 2);
+
+	//The new edit forgets the undone ones, the undone typing isn't continued
+	gp.Undo();
+	gp.Insert(0, '>');
+	EXPECT_FALSE(gp.CanRedo());
+	gp.Undo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), states[states.size() - 2]);
+
+	//Batch edits are undone in one step
+	const string text = "__";
+	const vector<GapBuffer::edit> edits = { { 0, 1, text }, { 4, 2, {} }, { 8, 0, text } };
+	gp.BatchEdit(edits);
+	const string edited = "__lo st__ed\nwo";
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), edited);
+	gp.Undo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), states[states.size() - 2]);
+	gp.Redo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), edited);
+
+	GapBuffer copy(gp);
+	copy.Undo();
+	EXPECT_EQ(string(cbegin(copy), cend(copy)), states[states.size() - 2]) << "Copy doesn't take the history.";
+	gp.Clear();
+	EXPECT_FALSE(gp.CanUndo());
+
+	//Delete and Backspace around the caret continue one record
+	const string line = "backspace";
+	gp.Insert(0, begin(line), end(line));
+	for (size_t caret = 4; caret > 0; --caret) {
+		gp.Erase(cbegin(gp) + caret);                          //Delete
+		gp.Erase(cbegin(gp) + caret - 1);                      //Backspace
+	}
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "e");
+	gp.Undo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), line) << "Removals around the caret aren't coalesced.";
+	gp.Redo();
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), "e");
+}
+
+TEST(BasicGapBufferTest, UndoBudget) {
+	CountingResource counter;
+	PmrGapBuffer gp(&counter);
+	gp.Insert(0, 1'000'000, 'x');
+	gp.EnableUndo(16 << 10);
+	const string word = "word ";
+	for (size_t i = 0; i < 2'000; ++i)
+		gp.Insert(i * 397 % gp.Size(), begin(word), end(word));
+	EXPECT_LE(gp.UndoMemory(), 16 << 10);
+	const auto allocations = counter.allocations;
+
+	size_t steps = 0;
+	while (gp.Undo())
+		++steps;
+	EXPECT_GT(steps, 0);
+	EXPECT_LT(steps, 2'000) << "Budget isn't applied.";
+	EXPECT_EQ(counter.allocations, allocations) << "Undo copies the data.";
+	EXPECT_EQ(gp.Size(), 1'000'000 + (2'000 - steps) * word.size());
+
+	gp.DisableUndo();
+	gp.Insert(0, 'x');
+	EXPECT_FALSE(gp.CanUndo());
+}
+
+//The moves go over 90 bytes to both sides, the storage grows once
+TEST(BasicGapBufferTest, Stats) {
+	GapBuffer gp;
+	gp.Insert(0, 100, 'x');
+	gp.Insert(10, 'y');
+	gp.Insert(101, 'z');
+	const gap_stats stats = gp.Stats();
+#if GAPBUFFER_STATS
+	EXPECT_EQ(stats.move_calls, 3);
+	EXPECT_EQ(stats.gap_moves, 2);
+	EXPECT_EQ(stats.bytes_moved_left, 90);
+	EXPECT_EQ(stats.bytes_moved_right, 90);
+	EXPECT_EQ(stats.expansions, 1);
+	EXPECT_EQ(stats.expansion_bytes, gp.StorageSize());
+	EXPECT_EQ(stats.peak_storage_bytes, gp.StorageSize());
+	EXPECT_EQ(stats.move_distances[6], 2) << "Moves of 90 bytes are in the bucket from 64.";
+
+	const string json = gp.DumpStats();
+	EXPECT_EQ(json.find("{\"enabled\":true,\"move_calls\":3,\"gap_moves\":2,"), 0);
+	EXPECT_NE(json.find("\"move_distances\":[{\"min_bytes\":64,\"count\":2}]"), string::npos);
+
+	gp.ResetStats();
+	EXPECT_EQ(gp.Stats().gap_moves, 0);
+	if (gp.SampleCacheMisses()) {
+		gp.Insert(0, 'y');
+		EXPECT_EQ(gp.Stats().sampled_moves, 1);
+		EXPECT_TRUE(gp.Stats().cache_miss_sampling);
+	}
+	GapBuffer copy(gp);
+	EXPECT_EQ(copy.Stats().move_calls, 0) << "Copy takes the counters.";
+#else
+	EXPECT_EQ(stats.move_calls, 0);
+	EXPECT_FALSE(gp.SampleCacheMisses());
+	EXPECT_EQ(gp.DumpStats().find("{\"enabled\":false"), 0);
+#endif
+}
+
+//The chunked buffer is compared with the string after every edit, the edits are
+//large enough to split and merge the leaves
+TEST(ChunkedGapBufferTest, RandomEdits) {
+	constexpr size_t leaf = ChunkedGapBuffer::leaf_capacity;
+	mt19937 random(42);
+	ChunkedGapBuffer gp;
+	string text;
+	const string chunk(leaf + leaf / 3, 'c');
+	for (int step = 0; step < 300; ++step) {
+		const size_t index = random() % (text.size() + 1);
+		switch (random() % 5) {
+		case 0:
+			gp.Insert(index, static_cast<char>('a' + step % 26));
+			text.insert(index, 1, static_cast<char>('a' + step % 26));
+			break;
+		case 1:
+			gp.Insert(index, begin(chunk), begin(chunk) + random() % chunk.size());
+			text.insert(index, chunk, 0, gp.Size() - text.size());
+			break;
+		case 2:
+			gp.Insert(index, random() % 1'000, static_cast<char>('A' + step % 26));
+			text.insert(index, gp.Size() - text.size(), static_cast<char>('A' + step % 26));
+			break;
+		default: {
+			const size_t count = min<size_t>(random() % (leaf / 2), text.size() - index);
+			gp.Erase(cbegin(gp) + index, cbegin(gp) + index + count);
+			text.erase(index, count);
+		}
+		}
+		ASSERT_EQ(gp.Size(), text.size()) << "Size mistake on the step " << step;
+		if (!text.empty()) {
+			ASSERT_EQ(gp[index % text.size()], text[index % text.size()]) << "operator[] mistake on the step " << step;
+		}
+	}
+	EXPECT_GT(gp.LeafCount(), 2);
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text);
+	for (size_t i = 0; i < gp.LeafCount(); ++i)
+		EXPECT_LE(gp.Leaf(i).StorageSize(), leaf) << "Leaf storage grows.";
+
+	gp.Erase(cbegin(gp), cend(gp));
+	EXPECT_EQ(gp.Size(), 0);
+	EXPECT_EQ(gp.LeafCount(), 1);
+}
+
+TEST(ChunkedGapBufferTest, Iterators) {
+	const size_t size = ChunkedGapBuffer::leaf_capacity * 3;
+	string text(size, 0);
+	for (size_t i = 0; i < size; ++i)
+		text[i] = static_cast<char>('a' + i % 26);
+	ChunkedGapBuffer gp(begin(text), end(text));
+	gp.Insert(size / 2, '*');
+	text.insert(size / 2, 1, '*');
+	ASSERT_GT(gp.LeafCount(), 1);
+
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text);
+	EXPECT_EQ(string(make_reverse_iterator(cend(gp)), make_reverse_iterator(cbegin(gp))), string(crbegin(text), crend(text))) << "Backward pass mistake.";
+	EXPECT_EQ(cend(gp) - cbegin(gp), text.size());
+	for (size_t i : { size_t(0), size / 3, size / 2, size / 2 + 1, size - 1, size }) {
+		const auto it = cbegin(gp) + i;
+		EXPECT_EQ(it - cbegin(gp), i);
+		EXPECT_EQ(*it, text[i]);
+		EXPECT_TRUE(it < cend(gp));
+	}
+
+	for (auto it = begin(gp); it != end(gp); ++it)
+		*it = static_cast<char>(toupper(*it));
+	transform(begin(text), end(text), begin(text), [](char c) { return static_cast<char>(toupper(c)); });
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text);
+
+	auto it = gp.Erase(cbegin(gp) + size / 2);
+	EXPECT_EQ(*it, text[size / 2 + 1]);
+	EXPECT_THROW(gp.Erase(cend(gp)), out_of_range);
+	EXPECT_THROW(gp.Insert(gp.Size() + 1, 'x'), invalid_argument);
+	ChunkedGapBuffer copy(cbegin(gp), cend(gp));
+	EXPECT_TRUE(copy == gp);
+#if GAPBUFFER_CHECKED_ITERATORS
+	EXPECT_THROW(*cend(gp), out_of_range);
+	EXPECT_THROW(cbegin(gp) - 1, out_of_range);
+#endif
+}
+
+TEST(ChunkedGapBufferTest, Snapshot) {
+	const size_t size = ChunkedGapBuffer::leaf_capacity * 4;
+	string text(size, 'x');
+	ChunkedGapBuffer gp(begin(text), end(text));
+	const auto snapshot = gp.Snapshot();
+	ASSERT_EQ(snapshot->LeafCount(), gp.LeafCount());
+	for (size_t i = 0; i < gp.LeafCount(); ++i)
+		EXPECT_EQ(&snapshot->Leaf(i), &gp.Leaf(i)) << "Snapshot copies the leaves.";
+
+	gp.Insert(size / 2, 'y');
+	gp.Erase(cbegin(gp), cbegin(gp) + 10);
+	gp[size - 100] = 'z';
+	*(begin(gp) + 5) = 'w';
+	EXPECT_EQ(string(cbegin(*snapshot), cend(*snapshot)), text) << "Edit changes the snapshot.";
+	EXPECT_NE(string(cbegin(gp), cend(gp)), text);
+	EXPECT_EQ(&snapshot->Leaf(1), &gp.Leaf(1)) << "Untouched leaf is copied.";
+
+	ChunkedGapBuffer copy(gp);
+	copy.Insert(0, 'c');
+	EXPECT_EQ(copy.Size(), gp.Size() + 1);
+	EXPECT_EQ(gp[0], 'x');
+}
+
+//Readers check the snapshots on other threads while the buffer is edited
+TEST(ChunkedGapBufferTest, ConcurrentSnapshots) {
+	ChunkedGapBuffer gp;
+	string text;
+	mt19937 random(7);
+	vector<future<bool>> readers;
+	const string word = "concurrent";
+	for (int step = 0; step < 400; ++step) {
+		const size_t index = random() % (text.size() + 1);
+		if (step % 4 == 3 && text.size() > 20'000) {
+			gp.Erase(cbegin(gp) + index / 2, cbegin(gp) + index / 2 + 10'000);
+			text.erase(index / 2, 10'000);
+		}
+		else {
+			gp.Insert(index, 3'000, static_cast<char>('a' + step % 26));
+			text.insert(index, 3'000, static_cast<char>('a' + step % 26));
+		}
+		if (step % 40 == 0)
+			readers.push_back(async(launch::async, [snapshot = gp.Snapshot(), expected = text] {
+				return string(cbegin(*snapshot), cend(*snapshot)) == expected;
+			}));
+	}
+	for (auto& reader : readers)
+		EXPECT_TRUE(reader.get()) << "Snapshot is changed while it's read.";
+	EXPECT_EQ(string(cbegin(gp), cend(gp)), text);
+}
+
+//The writer keeps the data as the repeated "ab", every published view must keep it too
+TEST(ConcurrentGapBufferTest, ReadersSeeWholeEdits) {
+	ConcurrentGapBuffer gp;
+	const string pair = "ab";
+	gp.Insert(0, pair);
+	atomic<bool> done = false;
+	auto reader = [&gp, &done] {
+		size_t views = 0;
+		ConcurrentGapBuffer::version_type last = 0;
+		while (!done || views == 0) {
+			const auto state = gp.Read();
+			if (state.Version() < last)
+				return false;
+			last = state.Version();
+			const auto& data = *state;
+			if (data.Size() % 2 != 0)
+				return false;
+			size_t i = 0;
+			for (auto it = cbegin(data); it != cend(data); ++it, ++i)
+				if (*it != (i % 2 == 0 ? 'a' : 'b'))
+					return false;
+			++views;
+		}
+		return true;
+	};
+	vector<future<bool>> readers;
+	for (int i = 0; i < 3; ++i)
+		readers.push_back(async(launch::async, reader));
+
+	mt19937 random(3);
+	const string text(20'000, 'x');
+	for (int step = 0; step < 500; ++step) {
+		const size_t index = random() % (gp.Writer().Size() / 2 + 1) * 2;
+		if (step % 3 == 2)
+			gp.Erase(index, min<size_t>(2'000, gp.Writer().Size() - index));
+		else
+			gp.Edit([&](ChunkedGapBuffer& data) {
+				for (size_t i = 0; i < 1'000; ++i)
+					data.Insert(index, pair);
+			});
+	}
+	done = true;
+	for (auto& result : readers)
+		EXPECT_TRUE(result.get()) << "Reader sees a torn edit.";
+
+	gp.Publish();
+	EXPECT_EQ(gp.Retired(), 0) << "Snapshots aren't freed.";
+	{
+		const auto state = gp.Read();
+		EXPECT_TRUE(gp.IsCurrent(state));
+		EXPECT_EQ(state.Version(), gp.Version());
+		EXPECT_TRUE(*state == gp.Writer());
+
+		//Single edits are published for the reader which has seen the old snapshot
+		gp.Insert(0, pair);
+		gp.Insert(0, pair);
+		EXPECT_FALSE(gp.IsCurrent(state)) << "Old view is current.";
+		EXPECT_EQ(gp.Retired(), 0) << "Edit is published without readers.";
+		EXPECT_EQ(gp.Read()->Size(), state->Size());
+		gp.Insert(0, pair);
+		EXPECT_EQ(gp.Retired(), 1) << "Edit isn't published for the reader.";
+		gp.Publish();
+		EXPECT_EQ(gp.Retired(), 1) << "Published data is published again.";
+		const auto fresh = gp.Read();
+		EXPECT_TRUE(gp.IsCurrent(fresh));
+		EXPECT_EQ(state->Size() + 6, fresh->Size());
+	}
+	gp.Reclaim();
+	EXPECT_EQ(gp.Retired(), 0);
+
+	//The readers over the slots share the overflow slot instead of waiting
+	vector<ConcurrentGapBuffer::read_guard> slotted;
+	vector<ConcurrentGapBuffer::read_guard> overflowed;
+	for (size_t i = 0; i < ConcurrentGapBuffer::max_readers; ++i)
+		slotted.push_back(gp.Read());
+	for (size_t i = 0; i < 2; ++i)
+		overflowed.push_back(gp.Read());
+	slotted.clear();
+	gp.Edit([&](ChunkedGapBuffer& data) { data.Insert(0, pair); });
+	EXPECT_EQ(gp.Retired(), 1) << "Snapshot of the overflow readers is freed.";
+	EXPECT_EQ(overflowed.back()->Size() + 2, gp.Writer().Size());
+	overflowed.clear();
+	gp.Reclaim();
+	EXPECT_EQ(gp.Retired(), 0) << "Overflow slot isn't released.";
+}
@@ -0,0 +1,4 @@
+#include "ChunkedGapBuffer.h"
+
+//The leaves and the iterators are templates, the char buffer is instantiated once here.
+template class basic_chunked_gap_buffer<char>;
@@ -0,0 +1,370 @@
+#ifndef CHUNKEDGAPBUFFER_H
+#define CHUNKEDGAPBUFFER_H
+
+#include "GapBuffer.h"
+#include "iterator.h"
+#include "const_iterator.h"
+#include "FenwickTree.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <span>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+
+//Gap buffer for very large documents. The data is split into the leaf gap buffers of
+//leaf_capacity elements, every leaf has its own gap. Leaf sizes are kept in the Fenwick
+//tree, so the leaf of an index is found in O(log n) and an edit moves the data of one
+//leaf only. Full leaves are split in halves, sparse neighbour leaves are merged.
+//Leaves are shared by the copies and the snapshots, the shared leaf is copied by its
+//first change, so a copy costs O(leaves) and an edit after it copies one leaf.
+template <class T, class Alloc = std::allocator<T>>
+class basic_chunked_gap_buffer {
+  public:
+	//Iterators
+	template <bool IsConst> class basic_iterator;
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+
+	//Synonymous
+	using leaf_type = basic_gap_buffer<T, Alloc>;
+	using value_type = T;
+	using allocator_type = Alloc;
+	using reference = T&;
+	using const_reference = const T&;
+	using difference_type = std::ptrdiff_t;
+	using size_type = std::size_t;
+	using segment = std::span<const T>;
+
+	//Leaf storages are allocated with this size at once and never grow
+	static constexpr size_type leaf_capacity = sizeof(T) < (64 << 10) ? (64 << 10) / sizeof(T) : 1;
+
+	//Constructors, destructors
+	basic_chunked_gap_buffer() : basic_chunked_gap_buffer(Alloc()) { }
+	explicit basic_chunked_gap_buffer(const Alloc& a) : leaves(pointer_allocator(a)), alloc(a) { Clear(); }
+	template <typename It> basic_chunked_gap_buffer(It beg, It end, const Alloc& a = Alloc()) : basic_chunked_gap_buffer(a) { Insert(0, beg, end); }
+
+	//Buffer changing functions
+	void Insert(const size_type&, const T&);
+	void Insert(const_iterator, const T&);
+	template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+	void Insert(const size_type&, It, It);                          //Insert the range filling the new leaves
+	void Insert(const size_type&, segment);
+	void Insert(const size_type&, const size_type&, const T&);      //Insert count copies of the element
+	iterator Erase(const_iterator);
+	iterator Erase(const_iterator, const_iterator);
+	void Clear();
+
+	//Status functions
+	size_type Size() const noexcept { return sizes.Total(); }
+	size_type LeafCount() const noexcept { return leaves.size(); }
+	const leaf_type& Leaf(const size_type& index) const { return *leaves[index]; }
+
+	//Immutable view of the current data. It shares the leaves with the buffer and can be read
+	//by other threads without locks while the buffer is edited, the edits copy the shared leaves.
+	//Snapshot invalidates the mutable iterators and the references of the buffer: they point
+	//to the shared leaves and a write through them would change the snapshot.
+	std::shared_ptr<const basic_chunked_gap_buffer> Snapshot() const { return std::allocate_shared<basic_chunked_gap_buffer>(alloc, *this); }
+
+	//Access functions, O(log n)
+	const T& operator[](const size_type&) const;
+	T& operator[](const size_type&);
+
+	//Range functions
+	const_iterator begin() const { return { this, 0, 0 }; }
+	iterator begin() { return { this, 0, 0 }; }
+	const_iterator end() const { return { this, leaves.size() - 1, leaves.back()->Size() }; }
+	iterator end() { return { this, leaves.size() - 1, leaves.back()->Size() }; }
+
+	//operators
+	bool operator==(const basic_chunked_gap_buffer& rhs) const { return Size() == rhs.Size() && std::equal(begin(), end(), rhs.begin()); }
+	bool operator!=(const basic_chunked_gap_buffer& rhs) const { return !(*this == rhs); }
+
+  private:
+	using leaf_pointer = std::shared_ptr<leaf_type>;
+	using leaf_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<leaf_type>;
+	using pointer_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<leaf_pointer>;
+
+	std::pair<size_type, size_type> Locate(const size_type&) const; //Leaf of the index and the index inside the leaf
+	template <typename Fill>
+	void InsertBulk(const size_type&, const size_type&, Fill);      //Insert count elements which are inserted by Fill to the leaves
+	void RemoveRange(const size_type&, const size_type&);
+	void SplitLeaf(const size_type&);
+	void MergeSparse(size_type);                                    //Remove the empty leaf or merge the small leaf with a neighbour
+	void RebuildSizes();
+	leaf_pointer MakeLeaf() const { return std::allocate_shared<leaf_type>(leaf_allocator(alloc), leaf_capacity, alloc); }
+	leaf_type& Unique(const size_type&);                            //Leaf to change, the shared leaf is copied
+	static void AppendRange(leaf_type&, const leaf_type&, const size_type&, const size_type&); //Append the index range of the leaf
+
+  private:
+	std::vector<leaf_pointer, pointer_allocator> leaves;            //Never empty, only the single leaf may be empty
+	fenwick_tree sizes;
+	[[no_unique_address]] allocator_type alloc;
+};
+
+using ChunkedGapBuffer = basic_chunked_gap_buffer<char>;
+
+#include "chunked_iterator.h"
+
+//Recieve the index which is not greater than the size. The size belongs to the end of the last leaf.
+template <class T, class Alloc>
+auto basic_chunked_gap_buffer<T, Alloc>::Locate(const size_type& index) const -> std::pair<size_type, size_type> {
+	if (index == Size())
+		return { leaves.size() - 1, leaves.back()->Size() };
+
+	size_type rank = index + 1;
+	const size_type leaf = sizes.Find(rank);
+	return { leaf, rank - 1 };
+}
+
+//Recieve the index and element. The full leaf is split before the insert.
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::Insert(const size_type& index, const T& item) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+
+	auto [leaf, local] = Locate(index);
+	if (leaves[leaf]->Size() == leaf_capacity) {
+		SplitLeaf(leaf);
+		const size_type half = leaves[leaf]->Size();
+		if (local > half) {
+			local -= half;
+			++leaf;
+		}
+	}
+	Unique(leaf).Insert(local, item);
+	sizes.Add(leaf, 1);
+}
+
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::Insert(const_iterator pos, const T& item) {
+	Insert(static_cast<size_type>(pos - std::cbegin(*this)), item);
+}
+
+template <class T, class Alloc>
+template <typename It, typename> void basic_chunked_gap_buffer<T, Alloc>::Insert(const size_type& index, It first, It last) {
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+		InsertBulk(index, static_cast<size_type>(std::distance(first, last)), [&first](leaf_type& leaf, const size_type& pos, const size_type& count) {
+			const It next = std::next(first, static_cast<difference_type>(count));
+			leaf.Insert(pos, first, next);
+			first = next;
+		});
+	}
+	else {
+		//Single pass iterators are read once to count them
+		const std::vector<T> items(first, last);
+		Insert(index, segment(items));
+	}
+}
+
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::Insert(const size_type& index, segment items) {
+	InsertBulk(index, items.size(), [&items](leaf_type& leaf, const size_type& pos, const size_type& count) {
+		leaf.Insert(pos, items.first(count));
+		items = items.subspan(count);
+	});
+}
+
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::Insert(const size_type& index, const size_type& count, const T& item) {
+	InsertBulk(index, count, [&item](leaf_type& leaf, const size_type& pos, const size_type& n) {
+		leaf.Insert(pos, n, item);
+	});
+}
+
+//Recieve the index, the count and the function which inserts the next elements to the leaf.
+//If the elements don't fit into the leaf of the index, the leaf is cut at the index, the elements
+//fill its rest and the new full leaves, and the cut tail is put after them.
+template <class T, class Alloc>
+template <typename Fill>
+void basic_chunked_gap_buffer<T, Alloc>::InsertBulk(const size_type& index, const size_type& count, Fill fill) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+	if (count == 0)
+		return;
+
+	const auto [leaf, local] = Locate(index);
+	leaf_type& target = Unique(leaf);
+	if (target.Size() + count <= leaf_capacity) {
+		fill(target, local, count);
+		sizes.Add(leaf, static_cast<difference_type>(count));
+		return;
+	}
+
+	const leaf_pointer tail = MakeLeaf();
+	AppendRange(*tail, target, local, target.Size());
+	target.Erase(std::cbegin(target) + local, std::cend(target));
+
+	size_type left = count;
+	const size_type head = std::min(left, leaf_capacity - target.Size());
+	fill(target, local, head);
+	left -= head;
+
+	std::vector<leaf_pointer, pointer_allocator> fresh(leaves.get_allocator());
+	fresh.reserve(left / leaf_capacity + 2);
+	while (left > 0) {
+		fresh.push_back(MakeLeaf());
+		const size_type part = std::min(left, leaf_capacity);
+		fill(*fresh.back(), 0, part);
+		left -= part;
+	}
+
+	leaf_type& last = fresh.empty() ? target : *fresh.back();
+	if (last.Size() + tail->Size() <= leaf_capacity)
+		AppendRange(last, *tail, 0, tail->Size());
+	else
+		fresh.push_back(tail);
+
+	leaves.insert(std::begin(leaves) + leaf + 1, std::begin(fresh), std::end(fresh));
+	RebuildSizes();
+}
+
+//Recieve the const_iterator which points to the element, remove this element.
+//Returns the iterator points to the next element.
+template <class T, class Alloc>
+auto basic_chunked_gap_buffer<T, Alloc>::Erase(const_iterator to_del) -> iterator {
+	const auto index = static_cast<size_type>(to_del - std::cbegin(*this));
+	if (index >= Size())
+		throw std::out_of_range("Iterator is out of range!");
+
+	RemoveRange(index, index + 1);
+	const auto [leaf, local] = Locate(index);
+	return { this, leaf, local };
+}
+
+//Recieve the const_iterator range, remove elements in the range [).
+template <class T, class Alloc>
+auto basic_chunked_gap_buffer<T, Alloc>::Erase(const_iterator beg, const_iterator end) -> iterator {
+	const auto index = static_cast<size_type>(beg - std::cbegin(*this));
+	RemoveRange(index, static_cast<size_type>(end - std::cbegin(*this)));
+	const auto [leaf, local] = Locate(index);
+	return { this, leaf, local };
+}
+
+//The leaves which are removed completely are erased at once, the first and the last
+//leaves of the range are cut.
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::RemoveRange(const size_type& beg, const size_type& end) {
+	if (beg > end || end > Size())
+		throw std::invalid_argument("Incorrect index.");
+	if (beg == end)
+		return;
+
+	const auto [first, first_local] = Locate(beg);
+	const auto [last, last_local] = Locate(end);
+	if (first == last) {
+		leaf_type& target = Unique(first);
+		target.Erase(std::cbegin(target) + first_local, std::cbegin(target) + last_local);
+		sizes.Add(first, -static_cast<difference_type>(end - beg));
+		MergeSparse(first);
+		return;
+	}
+
+	leaf_type& head = Unique(last);
+	head.Erase(std::cbegin(head), std::cbegin(head) + last_local);
+	leaf_type& tail = Unique(first);
+	tail.Erase(std::cbegin(tail) + first_local, std::cend(tail));
+	leaves.erase(std::begin(leaves) + first + 1, std::begin(leaves) + last);
+	if (leaves[first + 1]->Size() == 0)
+		leaves.erase(std::begin(leaves) + first + 1);
+	RebuildSizes();
+	MergeSparse(first);
+}
+
+//Recieve the full leaf, its second half is moved to the new leaf after it
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::SplitLeaf(const size_type& index) {
+	leaf_pointer right = MakeLeaf();
+	leaf_type& left = Unique(index);
+	const size_type half = left.Size() / 2;
+	AppendRange(*right, left, half, left.Size());
+	left.Erase(std::cbegin(left) + half, std::cend(left));
+	leaves.insert(std::begin(leaves) + index + 1, std::move(right));
+	RebuildSizes();
+}
+
+//Recieve the leaf index. Leaves are merged when they fit into the half of a leaf,
+//so the next inserts don't split them at once.
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::MergeSparse(size_type index) {
+	if (leaves.size() == 1)
+		return;
+
+	if (leaves[index]->Size() == 0) {
+		leaves.erase(std::begin(leaves) + index);
+		RebuildSizes();
+		return;
+	}
+	if (index + 1 == leaves.size() || leaves[index]->Size() + leaves[index + 1]->Size() > leaf_capacity / 2) {
+		if (index == 0 || leaves[index - 1]->Size() + leaves[index]->Size() > leaf_capacity / 2)
+			return;
+		--index;
+	}
+
+	AppendRange(Unique(index), *leaves[index + 1], 0, leaves[index + 1]->Size());
+	leaves.erase(std::begin(leaves) + index + 1);
+	RebuildSizes();
+}
+
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::RebuildSizes() {
+	std::vector<std::size_t> counts(leaves.size());
+	for (size_type i = 0; i < leaves.size(); ++i)
+		counts[i] = leaves[i]->Size();
+	sizes.Assign(std::move(counts));
+}
+
+//Recieve the destination, the source and the index range of the source. The parts of the
+//range before and after the source gap are appended with two contiguous inserts.
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::AppendRange(leaf_type& dst, const leaf_type& src, const size_type& beg, const size_type& end) {
+	const auto [before, after] = src.Segments();
+	if (beg < before.size())
+		dst.Insert(dst.Size(), before.subspan(beg, std::min(end, before.size()) - beg));
+	if (end > before.size()) {
+		const size_type from = std::max(beg, before.size()) - before.size();
+		dst.Insert(dst.Size(), after.subspan(from, end - before.size() - from));
+	}
+}
+
+template <class T, class Alloc>
+void basic_chunked_gap_buffer<T, Alloc>::Clear() {
+	leaves.clear();
+	leaves.push_back(MakeLeaf());
+	RebuildSizes();
+}
+
+template <class T, class Alloc>
+const T& basic_chunked_gap_buffer<T, Alloc>::operator[](const size_type& index) const {
+	const auto [leaf, local] = Locate(index);
+	const auto [before, after] = leaves[leaf]->Segments();
+	return local < before.size() ? before[local] : after[local - before.size()];
+}
+
+//The leaf of the element is copied if it's shared, the reference may be written
+template <class T, class Alloc>
+T& basic_chunked_gap_buffer<T, Alloc>::operator[](const size_type& index) {
+	Unique(Locate(index).first);
+	return const_cast<T&>(std::as_const(*this)[index]);
+}
+
+//The leaf can be shared only with the copies which are made by the owner of the buffer,
+//so the use count of 1 can't grow while it's checked. The count is read relaxed, the fence
+//orders the reads of the snapshot which has just released the leaf before the writes.
+template <class T, class Alloc>
+auto basic_chunked_gap_buffer<T, Alloc>::Unique(const size_type& index) -> leaf_type& {
+	leaf_pointer& leaf = leaves[index];
+	if (leaf.use_count() > 1)
+		leaf = std::allocate_shared<leaf_type>(leaf_allocator(alloc), *leaf, alloc);
+	else
+		std::atomic_thread_fence(std::memory_order_acquire);
+	return *leaf;
+}
+
+extern template class basic_chunked_gap_buffer<char>;
+
+#endif
@@ -0,0 +1,4 @@
+#include "ConcurrentGapBuffer.h"
+
+//The char buffer is instantiated once here.
+template class basic_concurrent_gap_buffer<char>;
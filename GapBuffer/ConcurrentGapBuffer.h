@@ -0,0 +1,201 @@
+#ifndef CONCURRENTGAPBUFFER_H
+#define CONCURRENTGAPBUFFER_H
+
+#include "ChunkedGapBuffer.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <span>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+//Gap buffer for one writer and many readers. The writer edits its own chunked buffer and
+//publishes the snapshot of it, the snapshot shares the leaves and is never changed. Edit
+//publishes its changes at once, single Insert and Erase are published only when a reader
+//has asked for the newer data since the last snapshot, or by Publish. So the typing doesn't
+//copy the leaf vector and the edited leaf on every element. Readers take the last published
+//snapshot without locks, so they never see a half done edit, and compare its version with
+//the writer one to know if it's behind.
+//Old snapshots are freed by the writer with the epoch based reclamation: every reader
+//pins the version which it started with, and the snapshot is freed when all pinned versions
+//are newer than it. Readers don't free anything, all leaf counters are changed by the writer.
+template <class T, class Alloc = std::allocator<T>>
+class basic_concurrent_gap_buffer {
+  public:
+	//Synonymous
+	using buffer_type = basic_chunked_gap_buffer<T, Alloc>;
+	using value_type = T;
+	using allocator_type = Alloc;
+	using size_type = std::size_t;
+	using segment = std::span<const T>;
+	using version_type = std::uint64_t;
+
+	//Readers which pin their own slot. The next ones share the overflow slot, it keeps the
+	//oldest version of them pinned until they all finish. Only the reader over max_readers
+	//and max_overflow_readers waits for a free slot.
+	static constexpr size_type max_readers = 64;
+	static constexpr size_type max_overflow_readers = (1 << 16) - 1;
+
+	//Published state of the buffer, it's never changed
+	struct published {
+		buffer_type buffer;
+		version_type version;
+	};
+
+	//Pinned snapshot, it stays valid until the guard is destroyed
+	class read_guard {
+	  public:
+		read_guard(read_guard&& rhs) noexcept : slot(std::exchange(rhs.slot, nullptr)), state(rhs.state), shared(rhs.shared) { }
+		read_guard(const read_guard&) = delete;
+		read_guard& operator=(const read_guard&) = delete;
+	   ~read_guard();
+
+		const buffer_type& operator*() const noexcept { return state->buffer; }
+		const buffer_type* operator->() const noexcept { return &state->buffer; }
+		version_type Version() const noexcept { return state->version; }
+
+	  private:
+		read_guard(std::atomic<version_type>* s, const published* p, bool overflow) noexcept : slot(s), state(p), shared(overflow) { }
+
+		std::atomic<version_type>* slot;
+		const published* state;
+		bool shared;                                                //The slot is the overflow one
+
+		friend class basic_concurrent_gap_buffer;
+	};
+
+	//Constructors, destructors
+	basic_concurrent_gap_buffer() : basic_concurrent_gap_buffer(Alloc()) { }
+	explicit basic_concurrent_gap_buffer(const Alloc& a) : buffer(a) { Publish(); }
+	basic_concurrent_gap_buffer(const basic_concurrent_gap_buffer&) = delete;
+	basic_concurrent_gap_buffer& operator=(const basic_concurrent_gap_buffer&) = delete;
+   ~basic_concurrent_gap_buffer() { delete current.load(std::memory_order_relaxed); } //Readers must be finished
+
+	//Writer functions, only one thread may call them. Edit applies all changes of the
+	//function and publishes them at once. The writer calls Publish when it stops editing,
+	//so the last single edits are seen by the readers which don't ask again.
+	template <typename Fn> void Edit(Fn&& fn) { fn(buffer); Changed(); Publish(); }
+	void Insert(const size_type& index, const T& item) { buffer.Insert(index, item); Changed(); }
+	void Insert(const size_type& index, segment items) { buffer.Insert(index, items); Changed(); }
+	void Erase(const size_type& index, const size_type& count) { buffer.Erase(std::cbegin(buffer) + index, std::cbegin(buffer) + index + count); Changed(); }
+	void Publish();                                                 //Publish the edits which aren't published yet
+	const buffer_type& Writer() const noexcept { return buffer; }  //The current data for the writer thread
+	void Reclaim();                                                 //Free the old snapshots which aren't read, every publish does it too
+	size_type Retired() const noexcept { return retired.size(); }  //Old snapshots which aren't freed yet
+
+	//Reader functions, any thread may call them
+	read_guard Read() const;
+	version_type Version() const noexcept { return latest.load(std::memory_order_acquire); } //Version of the last edit, it may be not published yet
+	bool IsCurrent(const read_guard& guard) const noexcept { return guard.Version() == Version(); }
+
+  private:
+	struct alignas(64) reader_slot {
+		std::atomic<version_type> pinned = 0;                       //0 if the slot is free
+	};
+
+	void Changed();                                                 //Count the edit and publish it if a reader waits for it
+
+	//The overflow slot keeps the pinned version above the count of its readers
+	static constexpr int overflow_bits = 16;
+	static constexpr version_type overflow_mask = (version_type(1) << overflow_bits) - 1;
+
+  private:
+	buffer_type buffer;
+	std::atomic<const published*> current = nullptr;
+	std::atomic<version_type> version = 0;                          //Version of the published snapshot
+	std::atomic<version_type> latest = 1;                           //Version of the last edit
+	mutable std::atomic<bool> requested = false;                    //A reader has seen the snapshot older than the last edit
+	std::vector<std::unique_ptr<const published>> retired;
+	mutable std::array<reader_slot, max_readers> slots;
+	mutable reader_slot overflow;
+};
+
+using ConcurrentGapBuffer = basic_concurrent_gap_buffer<char>;
+
+template <class T, class Alloc>
+basic_concurrent_gap_buffer<T, Alloc>::read_guard::~read_guard() {
+	if (slot == nullptr)
+		return;
+	if (shared)
+		slot->fetch_sub(1, std::memory_order_seq_cst);
+	else
+		slot->store(0, std::memory_order_release);
+}
+
+//The reader takes a free slot and pins the current version before it loads the snapshot,
+//so the pinned version can't be newer than the loaded snapshot. The search starts from the
+//slot of the thread, so the readers don't fight for the same slots. When all slots are
+//taken the reader joins the overflow slot: the first one pins the version there, the next
+//ones load the newer snapshots and are covered by it.
+template <class T, class Alloc>
+auto basic_concurrent_gap_buffer<T, Alloc>::Read() const -> read_guard {
+	if (version.load(std::memory_order_relaxed) < latest.load(std::memory_order_relaxed) && !requested.load(std::memory_order_relaxed))
+		requested.store(true, std::memory_order_relaxed);
+
+	const size_type start = std::hash<std::thread::id>()(std::this_thread::get_id()) % max_readers;
+	for (;;) {
+		for (size_type i = 0; i < max_readers; ++i) {
+			std::atomic<version_type>& slot = slots[(start + i) % max_readers].pinned;
+			version_type free = 0;
+			if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(free, version.load(std::memory_order_seq_cst), std::memory_order_seq_cst))
+				return { &slot, current.load(std::memory_order_seq_cst), false };
+		}
+
+		version_type readers = overflow.pinned.load(std::memory_order_seq_cst);
+		while ((readers & overflow_mask) < max_overflow_readers) {
+			const version_type joined = (readers & overflow_mask) == 0 ? (version.load(std::memory_order_seq_cst) << overflow_bits) + 1 : readers + 1;
+			if (overflow.pinned.compare_exchange_weak(readers, joined, std::memory_order_seq_cst))
+				return { &overflow.pinned, current.load(std::memory_order_seq_cst), true };
+		}
+		std::this_thread::yield();
+	}
+}
+
+//The snapshot is a copy which shares the leaves, so publishing costs O(leaves) and the
+//next write to a leaf copies it. Nothing is copied if all edits are published.
+template <class T, class Alloc>
+void basic_concurrent_gap_buffer<T, Alloc>::Publish() {
+	const version_type next = latest.load(std::memory_order_relaxed);
+	requested.store(false, std::memory_order_relaxed);
+	if (version.load(std::memory_order_relaxed) < next) {
+		auto state = std::make_unique<const published>(published{ buffer, next });
+		const published* old = current.exchange(state.release(), std::memory_order_seq_cst);
+		version.store(next, std::memory_order_seq_cst);
+		if (old != nullptr)
+			retired.emplace_back(old);
+	}
+	Reclaim();
+}
+
+template <class T, class Alloc>
+void basic_concurrent_gap_buffer<T, Alloc>::Changed() {
+	latest.store(latest.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	if (requested.load(std::memory_order_relaxed))
+		Publish();
+}
+
+//The reader which holds the old snapshot pinned the version before it was replaced,
+//so the snapshot is free when every pinned version is newer than it
+template <class T, class Alloc>
+void basic_concurrent_gap_buffer<T, Alloc>::Reclaim() {
+	version_type oldest = std::numeric_limits<version_type>::max();
+	for (const reader_slot& slot : slots) {
+		const version_type pinned = slot.pinned.load(std::memory_order_seq_cst);
+		if (pinned != 0)
+			oldest = std::min(oldest, pinned);
+	}
+	const version_type shared = overflow.pinned.load(std::memory_order_seq_cst);
+	if ((shared & overflow_mask) != 0)
+		oldest = std::min(oldest, shared >> overflow_bits);
+	std::erase_if(retired, [oldest](const auto& state) { return state->version < oldest; });
+}
+
+extern template class basic_concurrent_gap_buffer<char>;
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef EDITLOCALITY_H
+#define EDITLOCALITY_H
+
+#include <array>
+#include <cstddef>
+
+//Predictor of the next edit position. It keeps the last edit positions and finds the ping-pong
+//pattern: the edits jump between two hot spots which are far from each other, for example the
+//log tail and the header counter, so the next edit is expected at the spot before the last jump.
+//Positions are the indexes of the data. Positions closer than hot_spot_size to the previous one
+//of a spot belong to it, the typing at the spot and the inserts at the other one shift them a little.
+class edit_locality {
+  public:
+	static constexpr std::size_t history_size = 8;                 //Edits which the pattern is found in
+	static constexpr std::size_t hot_spot_size = 4096;
+
+	void Record(const std::size_t& index) noexcept {
+		positions[next] = index;
+		next = (next + 1) % history_size;
+		if (count < history_size)
+			++count;
+	}
+	void Clear() noexcept { count = next = 0; }
+
+	//Recieve the back step, 0 is the last recorded position
+	std::size_t Recent(const std::size_t& back) const noexcept { return positions[(next + history_size - 1 - back) % history_size]; }
+
+	//All recent edits are at two hot spots and they jump between them at least every second edit
+	bool IsPingPong() const noexcept {
+		if (count < history_size)
+			return false;
+
+		std::size_t spots[2] = { Recent(history_size - 1), 0 };
+		bool has_second = false;
+		std::size_t spot = 0;
+		std::size_t jumps = 0;
+		for (std::size_t back = history_size - 1; back-- > 0; ) {
+			const std::size_t index = Recent(back);
+			std::size_t next_spot;
+			if (Distance(index, spots[0]) <= hot_spot_size)
+				next_spot = 0;
+			else if (!has_second || Distance(index, spots[1]) <= hot_spot_size)
+				next_spot = 1;
+			else
+				return false;
+
+			has_second = has_second || next_spot == 1;
+			spots[next_spot] = index;
+			jumps += next_spot != spot;
+			spot = next_spot;
+		}
+		return jumps >= history_size / 2;
+	}
+
+	static std::size_t Distance(const std::size_t& lhs, const std::size_t& rhs) noexcept { return lhs < rhs ? rhs - lhs : lhs - rhs; }
+
+  private:
+	std::array<std::size_t, history_size> positions{};
+	std::size_t count = 0;                                          //Recorded positions, up to history_size
+	std::size_t next = 0;                                           //Place of the next position
+};
+
+#endif
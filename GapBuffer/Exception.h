@@ -2,49 +2,45 @@
 #define EXCEPTION_H
 
 #include <stdexcept>
-#include <functional>
-#include <cmath>
+#include <cstddef>
+
+//Iterator bounds checking policy. Checked iterators throw std::out_of_range,
+//unchecked ones are reduced to plain pointer arithmetic. By default iterators
+//are checked unless NDEBUG is defined, define GAPBUFFER_CHECKED_ITERATORS to 0 or 1
+//to choose the policy explicitly.
+#ifndef GAPBUFFER_CHECKED_ITERATORS
+#ifdef NDEBUG
+#define GAPBUFFER_CHECKED_ITERATORS 0
+#else
+#define GAPBUFFER_CHECKED_ITERATORS 1
+#endif
+#endif
 
 inline void ThrowOutOfRange() noexcept(false) {
-	throw std::out_of_range("Iterator is out of range or indicates to"
-		"position after the \0 symbol");
+	throw std::out_of_range("Iterator is out of range.");
 }
 
-template<typename GAPIt, typename It>
-inline bool IsIterOutOfRange(GAPIt base, It iter, const char& act, const int& shift) {
-	auto NegatShift = [&](const int& shf) -> bool {
-		if (shf > std::distance(base.data_beg, iter))
-			return true;
-
-		return false;
-	};
-
-	auto PositShift = [&](const int& shf) -> bool {
-		if (shf > std::distance(iter, base.data_end))
-			return true;
-		else if (iter + shf > std::find(base.data_beg, base.data_end, '\0'))
-			return true;
-
-		return false;
-	};
-
-	if (act == '-')
-		if (shift < 0)
-			return PositShift(abs(shift));
-		else
-			return NegatShift(shift);
-	else if (act == '+')
-		if (shift < 0)
-			return NegatShift(abs(shift));
-		else
-			return PositShift(shift);
-
+//Recieves the logical index of the iterator, the shift and the logical size of the
+//container. Returns true if the iterator will be out of [begin, end] after the shift.
+//Only compares the cached bounds, so it is O(1).
+inline bool IsIterOutOfRange(std::ptrdiff_t index, std::ptrdiff_t shift, std::ptrdiff_t size) noexcept {
+#if GAPBUFFER_CHECKED_ITERATORS
+	return shift < -index || shift > size - index;
+#else
+	(void)index; (void)shift; (void)size;
 	return false;
-
+#endif
 }
 
+//Returns true if the iterator with the physical position doesn't point to the end and can be dereferenced.
+template<typename It>
+inline bool IsIterDereferenceable(It ptr, It data_end) noexcept {
+#if GAPBUFFER_CHECKED_ITERATORS
+	return ptr != data_end;
+#else
+	(void)ptr; (void)data_end;
+	return true;
 #endif
+}
 
-
-
-
+#endif
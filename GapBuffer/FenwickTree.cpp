@@ -0,0 +1,46 @@
+#include "FenwickTree.h"
+#include <utility>
+#include <numeric>
+
+//Recieve all counts. The tree is built in place in linear time.
+void fenwick_tree::Assign(std::vector<std::size_t> counts) {
+	tree = std::move(counts);
+	total = std::accumulate(tree.begin(), tree.end(), std::size_t(0));
+	for (std::size_t i = 0; i < tree.size(); ++i) {
+		const std::size_t parent = i | (i + 1);
+		if (parent < tree.size())
+			tree[parent] += tree[i];
+	}
+}
+
+//Recieve the index and the change of its count. Negative changes are added modulo
+//size_t, the counts themselves never become negative.
+void fenwick_tree::Add(const std::size_t& index, const std::ptrdiff_t& delta) noexcept {
+	for (std::size_t i = index; i < tree.size(); i |= i + 1)
+		tree[i] += static_cast<std::size_t>(delta);
+	total += static_cast<std::size_t>(delta);
+}
+
+std::size_t fenwick_tree::PrefixSum(std::size_t count) const noexcept {
+	std::size_t sum = 0;
+	for (; count > 0; count &= count - 1)
+		sum += tree[count - 1];
+	return sum;
+}
+
+//Recieve the rank of the unit starting from 1, it must not exceed Total().
+//Descends the tree from the highest power of two, so the search is O(log n).
+std::size_t fenwick_tree::Find(std::size_t& rank) const noexcept {
+	std::size_t step = 1;
+	while (step * 2 <= tree.size())
+		step *= 2;
+
+	std::size_t index = 0;                                          //Count of the skipped counts
+	for (; step > 0; step /= 2) {
+		if (index + step <= tree.size() && tree[index + step - 1] < rank) {
+			index += step;
+			rank -= tree[index - 1];
+		}
+	}
+	return index;
+}
@@ -0,0 +1,26 @@
+#ifndef FENWICKTREE_H
+#define FENWICKTREE_H
+
+#include <vector>
+#include <cstddef>
+
+//Fenwick tree of counts. Changing a count, the sum of the first counts and the search
+//of the position by the sum are O(log n). GapBuffer keeps the line separators of its
+//storage chunks in it, the chunked buffer keeps the sizes of its leaves.
+class fenwick_tree {
+  public:
+	void Assign(std::vector<std::size_t> counts);                   //Build from the counts in O(n)
+	void Clear() noexcept { tree.clear(); total = 0; }
+	void Add(const std::size_t& index, const std::ptrdiff_t& delta) noexcept;
+
+	std::size_t Size() const noexcept { return tree.size(); }
+	std::size_t Total() const noexcept { return total; }
+	std::size_t PrefixSum(std::size_t count) const noexcept;        //Sum of the first count counts
+	std::size_t Find(std::size_t& rank) const noexcept;             //Index of the rank-th unit, rank becomes the rank inside the count
+
+  private:
+	std::vector<std::size_t> tree;                                  //tree[i] is the sum of the counts [i & (i + 1), i]
+	std::size_t total = 0;
+};
+
+#endif
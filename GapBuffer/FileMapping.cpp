@@ -0,0 +1,181 @@
+#include "FileMapping.h"
+#include <algorithm>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+//Files of the open mappings, the file mapped twice is listed twice
+std::mutex registry_mutex;
+std::vector<file_mapping::file_id> registry;
+
+void Register(const file_mapping::file_id& id) {
+	const std::lock_guard<std::mutex> lock(registry_mutex);
+	registry.push_back(id);
+}
+
+void Unregister(const file_mapping::file_id& id) noexcept {
+	const std::lock_guard<std::mutex> lock(registry_mutex);
+	const auto found = std::find(registry.begin(), registry.end(), id);
+	if (found != registry.end())
+		registry.erase(found);
+}
+
+bool IsRegistered(const file_mapping::file_id& id) {
+	const std::lock_guard<std::mutex> lock(registry_mutex);
+	return std::find(registry.begin(), registry.end(), id) != registry.end();
+}
+
+#ifdef _WIN32
+bool GetFileId(HANDLE file, file_mapping::file_id& id) {
+	BY_HANDLE_FILE_INFORMATION info;
+	if (!GetFileInformationByHandle(file, &info))
+		return false;
+	id = { info.dwVolumeSerialNumber, (static_cast<std::uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow };
+	return true;
+}
+#endif
+
+}
+
+#ifdef _WIN32
+//Handles of the file and the mapping object aren't needed after the view is mapped
+file_mapping::file_mapping(const std::filesystem::path& path) {
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "Can't open the file.");
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size)) {
+		const auto error = GetLastError();
+		CloseHandle(file);
+		throw std::system_error(static_cast<int>(error), std::system_category(), "Can't get the file size.");
+	}
+	if (file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return;
+	}
+	file_id mapped_id;
+	if (!GetFileId(file, mapped_id)) {
+		const auto error = GetLastError();
+		CloseHandle(file);
+		throw std::system_error(static_cast<int>(error), std::system_category(), "Can't get the file index.");
+	}
+
+	HANDLE map = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const auto map_error = GetLastError();
+	CloseHandle(file);
+	if (map == nullptr)
+		throw std::system_error(static_cast<int>(map_error), std::system_category(), "Can't map the file.");
+
+	view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	const auto view_error = GetLastError();
+	CloseHandle(map);
+	if (view == nullptr)
+		throw std::system_error(static_cast<int>(view_error), std::system_category(), "Can't map the file.");
+	size = static_cast<std::size_t>(file_size.QuadPart);
+	id = mapped_id;
+	try {
+		Register(id);
+	}
+	catch (...) {
+		UnmapViewOfFile(view);
+		throw;
+	}
+}
+
+void file_mapping::Close() noexcept {
+	if (view != nullptr) {
+		UnmapViewOfFile(view);
+		Unregister(id);
+	}
+	view = nullptr;
+	size = 0;
+}
+
+bool file_mapping::IsMapped(const std::filesystem::path& path) {
+	HANDLE file = CreateFileW(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	file_id path_id;
+	const bool known = GetFileId(file, path_id);
+	CloseHandle(file);
+	return known && IsRegistered(path_id);
+}
+#else
+//The descriptor isn't needed after the file is mapped
+file_mapping::file_mapping(const std::filesystem::path& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		throw std::system_error(errno, std::generic_category(), "Can't open the file.");
+
+	struct stat info;
+	if (::fstat(fd, &info) == -1) {
+		const int error = errno;
+		::close(fd);
+		throw std::system_error(error, std::generic_category(), "Can't get the file size.");
+	}
+	if (info.st_size == 0) {
+		::close(fd);
+		return;
+	}
+
+	void* mapped = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	const int error = errno;
+	::close(fd);
+	if (mapped == MAP_FAILED)
+		throw std::system_error(error, std::generic_category(), "Can't map the file.");
+
+	view = mapped;
+	size = static_cast<std::size_t>(info.st_size);
+	id = { static_cast<std::uint64_t>(info.st_dev), static_cast<std::uint64_t>(info.st_ino) };
+	try {
+		Register(id);
+	}
+	catch (...) {
+		::munmap(view, size);
+		throw;
+	}
+}
+
+void file_mapping::Close() noexcept {
+	if (view != nullptr) {
+		::munmap(view, size);
+		Unregister(id);
+	}
+	view = nullptr;
+	size = 0;
+}
+
+bool file_mapping::IsMapped(const std::filesystem::path& path) {
+	struct stat info;
+	if (::stat(path.c_str(), &info) == -1)
+		return false;
+	return IsRegistered({ static_cast<std::uint64_t>(info.st_dev), static_cast<std::uint64_t>(info.st_ino) });
+}
+#endif
+
+file_mapping& file_mapping::operator=(file_mapping&& rhs) noexcept {
+	if (this != &rhs) {
+		Close();
+		view = std::exchange(rhs.view, nullptr);
+		size = std::exchange(rhs.size, 0);
+		id = rhs.id;
+	}
+	return *this;
+}
@@ -0,0 +1,41 @@
+#ifndef FILEMAPPING_H
+#define FILEMAPPING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+//Read-only mapping of the whole file. Pages are read by the OS on the first access,
+//so opening a file doesn't read it. Empty files aren't mapped. The mapped files of the
+//process are registered, so the save doesn't write in place over the pages of a mapping.
+class file_mapping {
+  public:
+	//Device and inode, the volume and the file index on Windows
+	struct file_id {
+		std::uint64_t device = 0;
+		std::uint64_t index = 0;
+		bool operator==(const file_id&) const = default;
+	};
+
+	file_mapping() = default;
+	explicit file_mapping(const std::filesystem::path&);            //Throws std::system_error if the file can't be mapped
+	file_mapping(const file_mapping&) = delete;
+	file_mapping(file_mapping&& rhs) noexcept : view(rhs.view), size(rhs.size), id(rhs.id) { rhs.view = nullptr; rhs.size = 0; }
+	file_mapping& operator=(const file_mapping&) = delete;
+	file_mapping& operator=(file_mapping&&) noexcept;
+   ~file_mapping() { Close(); }
+
+	const char* Data() const noexcept { return static_cast<const char*>(view); }
+	std::size_t Size() const noexcept { return size; }
+	bool IsOpen() const noexcept { return view != nullptr; }
+	void Close() noexcept;
+
+	static bool IsMapped(const std::filesystem::path&);             //Some mapping of the process maps the file
+
+  private:
+	void* view = nullptr;
+	std::size_t size = 0;
+	file_id id;
+};
+
+#endif
@@ -0,0 +1,307 @@
+#include "FileWriter.h"
+#include "FileMapping.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <process.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+[[noreturn]] void ThrowSystemError(const char* what) {
+	throw std::system_error(errno, std::generic_category(), what);
+}
+
+//The temporary file is created next to the target, so the rename doesn't cross the file systems
+std::filesystem::path TempPath(const std::filesystem::path& path) {
+	static std::atomic<unsigned> counter = 0;
+#ifdef _WIN32
+	const auto process = _getpid();
+#else
+	const auto process = ::getpid();
+#endif
+	std::string name = ".";
+	name += path.filename().string();
+	name += ".tmp" + std::to_string(process) + "_" + std::to_string(counter++);
+	return path.parent_path() / name;
+}
+
+#ifdef _WIN32
+using io_size = unsigned int;                                       //_write takes the count as unsigned int
+constexpr std::size_t max_write = 1u << 30;
+
+void WriteAll(int fd, const std::byte* data, std::size_t size) {
+	while (size > 0) {
+		const int written = _write(fd, data, static_cast<io_size>(std::min(size, max_write)));
+		if (written == -1)
+			ThrowSystemError("Can't write the file.");
+		data += written;
+		size -= static_cast<std::size_t>(written);
+	}
+}
+#else
+//Cursor over the two segments. Every write is one writev of both of them, partial
+//writes and interrupts are continued from the written position.
+class segment_writer {
+  public:
+	segment_writer(std::span<const std::byte> first, std::span<const std::byte> second)
+		: parts{ { const_cast<std::byte*>(first.data()), first.size() }, { const_cast<std::byte*>(second.data()), second.size() } } {
+		Advance(0);
+	}
+
+	std::size_t Remaining() const noexcept {
+		std::size_t size = 0;
+		for (std::size_t i = current; i < 2; ++i)
+			size += parts[i].iov_len;
+		return size;
+	}
+
+	//Recieve the descriptor and the count of bytes to write from the current position
+	void Write(int fd, std::size_t limit) {
+		while (limit > 0 && current < 2) {
+			iovec io[2];
+			int count = 0;
+			std::size_t left = limit;
+			for (std::size_t i = current; i < 2 && left > 0; ++i, ++count) {
+				io[count] = parts[i];
+				io[count].iov_len = std::min(parts[i].iov_len, left);
+				left -= io[count].iov_len;
+			}
+
+			const ssize_t written = ::writev(fd, io, count);
+			if (written == -1) {
+				if (errno == EINTR)
+					continue;
+				ThrowSystemError("Can't write the file.");
+			}
+			Advance(static_cast<std::size_t>(written));
+			limit -= static_cast<std::size_t>(written);
+		}
+	}
+
+	//Recieve the destination and its size, returns the count of copied bytes
+	std::size_t Copy(std::byte* dst, std::size_t limit) noexcept {
+		std::size_t copied = 0;
+		while (copied < limit && current < 2) {
+			const std::size_t count = std::min(parts[current].iov_len, limit - copied);
+			std::memcpy(dst + copied, parts[current].iov_base, count);
+			copied += count;
+			Advance(count);
+		}
+		return copied;
+	}
+
+  private:
+	void Advance(std::size_t count) noexcept {
+		for (; current < 2; ++current) {
+			const std::size_t step = std::min(count, parts[current].iov_len);
+			parts[current].iov_base = static_cast<std::byte*>(parts[current].iov_base) + step;
+			parts[current].iov_len -= step;
+			count -= step;
+			if (parts[current].iov_len != 0)
+				break;
+		}
+	}
+
+	iovec parts[2];
+	std::size_t current = 0;
+};
+
+constexpr std::size_t direct_block = 4096;
+constexpr std::size_t write_window = 8 << 20;
+
+void WriteAll(int fd, const std::byte* data, std::size_t size) {
+	while (size > 0) {
+		const ssize_t written = ::write(fd, data, size);
+		if (written == -1) {
+			if (errno == EINTR)
+				continue;
+			ThrowSystemError("Can't write the file.");
+		}
+		data += written;
+		size -= static_cast<std::size_t>(written);
+	}
+}
+
+//O_DIRECT needs the aligned memory, offsets and sizes, the data is copied through
+//the aligned window and the padding of the last block is cut off.
+void WriteDirect(int fd, segment_writer& writer) {
+	const std::unique_ptr<std::byte, decltype(&std::free)> window(static_cast<std::byte*>(std::aligned_alloc(direct_block, write_window)), &std::free);
+	if (!window)
+		throw std::bad_alloc();
+
+	off_t total = 0;
+	while (writer.Remaining() > 0) {
+		const std::size_t filled = writer.Copy(window.get(), write_window);
+		const std::size_t aligned = (filled + direct_block - 1) / direct_block * direct_block;
+		std::memset(window.get() + filled, 0, aligned - filled);
+		WriteAll(fd, window.get(), aligned);
+		total += static_cast<off_t>(filled);
+	}
+	if (::ftruncate(fd, total) == -1)
+		ThrowSystemError("Can't truncate the file.");
+}
+
+//Every window is written back while the next one is written, so the dirty pages
+//don't pile up and the disk is busy all the time.
+void WriteWindows(int fd, segment_writer& writer) {
+#ifdef __linux__
+	off_t offset = 0;
+	off_t previous = 0;
+	std::size_t previous_size = 0;
+	while (writer.Remaining() > 0) {
+		const std::size_t size = std::min(writer.Remaining(), write_window);
+		writer.Write(fd, size);
+		::sync_file_range(fd, offset, static_cast<off_t>(size), SYNC_FILE_RANGE_WRITE);
+		if (previous_size != 0) {
+			::sync_file_range(fd, previous, static_cast<off_t>(previous_size), SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+			::posix_fadvise(fd, previous, static_cast<off_t>(previous_size), POSIX_FADV_DONTNEED);
+		}
+		previous = offset;
+		previous_size = size;
+		offset += static_cast<off_t>(size);
+	}
+#else
+	writer.Write(fd, writer.Remaining());
+#endif
+}
+
+//The rename is durable only after the directory is synced
+void SyncDirectory(const std::filesystem::path& path) {
+	const auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+	const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd == -1)
+		return;
+	::fsync(fd);
+	::close(fd);
+}
+#endif
+
+}
+
+#ifdef _WIN32
+void WriteSegments(int fd, std::span<const std::byte> first, std::span<const std::byte> second) {
+	WriteAll(fd, first.data(), first.size());
+	WriteAll(fd, second.data(), second.size());
+}
+
+//Windows has no sync_file_range and O_DIRECT, every sync mode is _commit. The mapped file
+//can't be truncated, it's replaced by the rename as on the other systems.
+void SaveSegments(const std::filesystem::path& path, std::span<const std::byte> first, std::span<const std::byte> second, const save_options& requested) {
+	save_options options = requested;
+	options.atomic = options.atomic || file_mapping::IsMapped(path);
+	const auto target = options.atomic ? TempPath(path) : path;
+	const int flags = _O_WRONLY | _O_CREAT | _O_BINARY | (options.atomic ? _O_TRUNC | _O_EXCL : 0);
+	int fd = -1;
+	if (_wsopen_s(&fd, target.c_str(), flags, _SH_DENYWR, _S_IREAD | _S_IWRITE) != 0)
+		ThrowSystemError("Can't open the file.");
+
+	try {
+		WriteSegments(fd, first, second);
+		if (_chsize_s(fd, static_cast<long long>(first.size() + second.size())) != 0)
+			ThrowSystemError("Can't truncate the file.");
+		if (options.sync != save_sync::none && _commit(fd) != 0)
+			ThrowSystemError("Can't sync the file.");
+	}
+	catch (...) {
+		_close(fd);
+		if (options.atomic)
+			_wunlink(target.c_str());
+		throw;
+	}
+	if (_close(fd) != 0)
+		ThrowSystemError("Can't close the file.");
+
+	if (options.atomic && !MoveFileExW(target.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		const auto error = GetLastError();
+		_wunlink(target.c_str());
+		throw std::system_error(static_cast<int>(error), std::system_category(), "Can't rename the file.");
+	}
+}
+#else
+void WriteSegments(int fd, std::span<const std::byte> first, std::span<const std::byte> second) {
+	segment_writer writer(first, second);
+	writer.Write(fd, writer.Remaining());
+}
+
+//Recieve the path, the segments and the options. The in-place write changes the pages of
+//the private mappings which aren't read yet and the truncation makes their tail SIGBUS, so
+//the file mapped in the process is always replaced by the rename.
+void SaveSegments(const std::filesystem::path& path, std::span<const std::byte> first, std::span<const std::byte> second, const save_options& requested) {
+	save_options options = requested;
+	options.atomic = options.atomic || file_mapping::IsMapped(path);
+	const auto target = options.atomic ? TempPath(path) : path;
+	const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (options.atomic ? O_EXCL : 0);
+	bool direct = options.sync == save_sync::direct;
+	int fd = -1;
+#ifdef O_DIRECT
+	if (direct)
+		fd = ::open(target.c_str(), flags | O_DIRECT, 0666);
+#endif
+	//File systems without O_DIRECT support are written through the page cache
+	if (fd == -1) {
+		direct = false;
+		fd = ::open(target.c_str(), flags, 0666);
+	}
+	if (fd == -1)
+		ThrowSystemError("Can't open the file.");
+
+	try {
+		//The replaced file keeps its permissions
+		struct stat info;
+		if (options.atomic && ::stat(path.c_str(), &info) == 0)
+			::fchmod(fd, info.st_mode & 07777);
+
+		segment_writer writer(first, second);
+		if (direct)
+			WriteDirect(fd, writer);
+		else if (options.sync == save_sync::range)
+			WriteWindows(fd, writer);
+		else
+			writer.Write(fd, writer.Remaining());
+
+		if (!options.atomic && ::ftruncate(fd, static_cast<off_t>(first.size() + second.size())) == -1)
+			ThrowSystemError("Can't truncate the file.");
+		if (options.sync != save_sync::none && ::fdatasync(fd) == -1)
+			ThrowSystemError("Can't sync the file.");
+	}
+	catch (...) {
+		::close(fd);
+		if (options.atomic)
+			::unlink(target.c_str());
+		throw;
+	}
+	if (::close(fd) == -1)
+		ThrowSystemError("Can't close the file.");
+
+	if (!options.atomic)
+		return;
+	if (::rename(target.c_str(), path.c_str()) == -1) {
+		const int error = errno;
+		::unlink(target.c_str());
+		throw std::system_error(error, std::generic_category(), "Can't rename the file.");
+	}
+	if (options.sync != save_sync::none)
+		SyncDirectory(path);
+}
+#endif
@@ -0,0 +1,27 @@
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+//How the saved data reaches the disk
+enum class save_sync {
+	none,                                                           //Left in the page cache
+	data,                                                           //fdatasync after the write
+	range,                                                          //Written back by windows with sync_file_range while writing, then fdatasync
+	direct                                                          //O_DIRECT through the aligned buffer, the page cache is bypassed
+};
+
+struct save_options {
+	bool atomic = true;                                             //Write the temporary file and rename it over the target, the mapped files are always replaced
+	save_sync sync = save_sync::none;
+};
+
+//Write functions take the data before and after the gap and write both at once
+//without joining them. Errors are thrown as std::system_error. The in-place save isn't
+//seen by the mappings of this process, the mappings of other processes see it.
+void WriteSegments(int fd, std::span<const std::byte>, std::span<const std::byte>);
+void SaveSegments(const std::filesystem::path&, std::span<const std::byte>, std::span<const std::byte>, const save_options&);
+
+#endif
@@ -2,45 +2,196 @@
 #define GAPBUFFER_H
 
 #include <vector>
-//DEBUG
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+#include <new>
+#include <memory_resource>
+#include <regex>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "Kernels.h"
+#include "Parallel.h"
+#include "FenwickTree.h"
+#include "FileMapping.h"
+#include "FileWriter.h"
+#include "UndoJournal.h"
+#include "Stats.h"
+#include "EditLocality.h"
 #include <string>
 
-class GapBuffer {
+//Gap buffer of elements of type T. Trivially copyable types are moved with memmove,
+//other types with the element-wise std::move. GapBuffer is the char case.
+//Storage comes from Alloc, small storages of trivial types are kept inline
+//in the object and don't allocate at all.
+template <class T, class Alloc = std::allocator<T>>
+class basic_gap_buffer {
+	using alloc_traits = std::allocator_traits<Alloc>;
+
   public:
 	//Iterators
 	class const_iterator;
 	class iterator;
 
 	//Synonymous
-	using value_type = std::vector<char>::value_type;
-	using reference = std::vector<char>::reference;
-	using const_reference = std::vector<char>::const_reference;
-	using difference_type = std::vector<char>::difference_type;
-	using size_type = std::vector<char>::size_type;
-	using pointer = std::vector<char>::pointer;
-	using const_pointer = std::vector<char>::const_pointer;
+	using value_type = T;
+	using allocator_type = Alloc;
+	using reference = T&;
+	using const_reference = const T&;
+	using difference_type = std::ptrdiff_t;
+	using size_type = std::size_t;
+	using pointer = T*;
+	using const_pointer = const T*;
+	using segment = std::span<const T>;                             //Contiguous part of the data
+
+	//Storage growth settings. The storage grows by factor but at least up to the
+	//needed size plus min_gap. If shrink_threshold isn't 0, the storage is shrunk
+	//after a removal when the gap takes more than this part of the storage.
+	//The adaptive policy sizes the new gap by twice the elements inserted since the last
+	//growth but at least by 1/16 of the data, factor is the upper bound. It also keeps the gap
+	//at its hot spot when the edits ping-pong between two hot spots (read edit_locality): the
+	//edit at the other spot shifts the data between them, so it isn't moved there and back.
+	struct growth_policy {
+		double factor = 2.0;
+		size_type min_gap = 16;
+		double shrink_threshold = 0.0;
+		bool adaptive = false;
+	};
+
+	static constexpr size_type npos = static_cast<size_type>(-1);
+
+	//Replacement of erase_count elements from offset by the text
+	struct edit {
+		size_type offset;
+		size_type erase_count;
+		segment text;
+	};
+
+	//Result of the replacement, the speed counts the search and the rebuild of the data
+	struct replace_report {
+		size_type count = 0;                                        //Replaced matches
+		double megabytes_per_second = 0.0;
+	};
+
+	//Elements count which fits into the object without allocation
+	static constexpr size_type inline_capacity = std::is_trivial_v<T> && sizeof(T) <= 32 ? 32 / sizeof(T) : 0;
 
 	//Constructors, destructors
-	GapBuffer() : gap_start(0), gap_end(1), data(1) { }
-	explicit GapBuffer(const size_t& size) : gap_start(0), gap_end(size), data(size) { }
-	template <typename It> GapBuffer(It, It);                                       //Construct the data from iterator It points to char.
-	GapBuffer(GapBuffer&&) = default;
-   ~GapBuffer() = default;
+	basic_gap_buffer() : basic_gap_buffer(Alloc()) { }
+	explicit basic_gap_buffer(const Alloc& a) : basic_gap_buffer(1, a) { }
+	explicit basic_gap_buffer(const size_t& size, const Alloc& a = Alloc()) : gap_start(0), gap_end(size), alloc(a) { data = Allocate(size); capacity = size; }
+	template <typename It> basic_gap_buffer(It, It, const Alloc& = Alloc()); //Construct the data from iterator It points to T.
+	basic_gap_buffer(const basic_gap_buffer&);
+	basic_gap_buffer(const basic_gap_buffer&, const Alloc&);
+	basic_gap_buffer(basic_gap_buffer&&) noexcept;
+	basic_gap_buffer(basic_gap_buffer&&, const Alloc&);
+   ~basic_gap_buffer() { Deallocate(data, capacity); ReleaseSide(); }
+
+	//Maps the file of bytes. Reads are served from the mapping, the data is copied
+	//to the own storage only by the first edit or the first non-const iterator.
+	static basic_gap_buffer FromFile(const std::filesystem::path&, const Alloc& = Alloc());
+
+	//Save functions write the data before and after the gap with one writev, nothing is copied
+	void SaveTo(int) const;                                         //Write to the descriptor from its position
+	void SaveTo(const std::filesystem::path&, const save_options& = save_options()) const;
 
 	//Buffer changing functions
-	void Insert(const size_type&, const char&);
-	void Insert(const_iterator, const char&);
+	void Insert(const size_type&, const T&);
+	void Insert(const_iterator, const T&);
+	template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+	void Insert(const size_type&, It, It);                          //Insert the range of elements moving the gap once
+	void Insert(const size_type&, segment);
+	void Insert(const size_type&, const size_type&, const T&);      //Insert count copies of the element
 	iterator Erase(const_iterator);
 	iterator Erase(iterator);
 	iterator Erase(const_iterator, const_iterator);
 	iterator Erase(iterator, iterator);
-	void Clear() noexcept { data.clear(); data.shrink_to_fit(); data.push_back('\0'); gap_start = 0; gap_end = 1; }
+	std::vector<size_type> BatchEdit(std::span<const edit>);        //Apply sorted edits in one pass, returns the caret after every text
+	replace_report ReplaceAll(segment, segment);                    //Replace every non-overlapping pattern by the replacement in one pass
+	replace_report ReplaceAll(const std::basic_regex<T>&, segment); //Replace every regex match by the format with $& and $n
+	void Clear();                                                   //Inline types don't allocate
 
 	//Status functions
-	size_type StorageSize() const noexcept { return data.size(); } //The whole container size
+	size_type StorageSize() const noexcept { return capacity; }    //The whole container size
 	size_type GapSize() const { return gap_end - gap_start; }      //GapBuffer size
 	bool IsGapEmpty() const noexcept { return gap_start == gap_end; }
 	size_type Size() const { return StorageSize() - GapSize(); }   //Container size without gap buffer
+	bool IsInline() const noexcept { return data != nullptr && data == InlineData(); } //Storage is inside the object
+	bool IsMapped() const noexcept { return side != nullptr && side->mapping.IsOpen(); } //Storage is the mapped file which isn't edited yet
+	allocator_type GetAllocator() const { return alloc; }
+
+	//Storage policy functions
+	const growth_policy& GetGrowthPolicy() const noexcept { return policy; }
+	void SetGrowthPolicy(const growth_policy&);
+
+	//Contiguous access functions
+	std::pair<segment, segment> Segments() const noexcept;         //Data before and after the gap, no data movement
+	segment ContiguousView();                                       //Moves the gap to the end once and returns all data
+
+	//Search functions, 1-byte elements are processed by the SIMD kernels
+	size_type Find(const T&, size_type pos = 0) const;              //Index of the first item from pos or npos
+	size_type Count(const T&) const;                                //Count of the item in the buffer
+	size_type Find(segment, size_type pos = 0) const;               //Index of the first needle from pos or npos, the match may cross the gap
+	size_type RFind(segment, size_type pos = npos) const;           //Index of the last needle which starts not after pos or npos
+	std::vector<size_type> FindAll(segment) const;                  //Indexes of all non-overlapping needles
+
+	//Parallel functions split the data into the blocks of parallel_block bytes by the index,
+	//threads = 0 uses all hardware threads. The results don't depend on the gap position and the threads.
+	size_type ParallelFind(const T&, size_type threads = 0) const;
+	size_type ParallelFind(segment, size_type threads = 0) const;
+	size_type ParallelCount(const T&, size_type threads = 0) const;
+	size_type ParallelLineCount(size_type threads = 0) const;       //Lines by the scan, the line index isn't needed
+	std::uint64_t Hash() const;                                     //Hash of the data bytes, the same as ParallelHash gives
+	std::uint64_t ParallelHash(size_type threads = 0) const;
+
+	//Line functions. Lines are separated by '\n', lines and columns start from 0. The line
+	//index makes them logarithmic and is kept up to date by every edit, without it the data is scanned.
+	void EnableLineIndex(bool enable = true);
+	bool HasLineIndex() const noexcept { return side != nullptr && side->has_line_index; }
+	size_type LineCount() const;
+	size_type OffsetOfLine(const size_type&) const;                 //Index of the first element of the line
+	std::pair<size_type, size_type> LineColOf(const size_type&) const; //Line and column of the element index
+
+	//UTF-8 functions, the indexes are byte indexes. Every byte which isn't a continuation byte
+	//10xxxxxx starts a code point. The code point index is sampled like the line index, it keeps
+	//the code points of every storage chunk, so the seek is logarithmic and the edits update it.
+	void EnableCodePointIndex(bool enable = true);
+	bool HasCodePointIndex() const noexcept { return side != nullptr && side->has_code_point_index; }
+	size_type NextCodePoint(const size_type&) const;                //Start of the code point after the index or Size()
+	size_type PrevCodePoint(const size_type&) const;                //Start of the code point before the index or 0
+	size_type CodePointCount() const;
+	size_type OffsetOfCodePoint(const size_type&) const;            //Byte index of the code point, the count gives Size()
+	size_type CodePointsBefore(const size_type&) const;             //Code points which start before the byte index
+	bool IsValidUtf8() const;                                       //The sequence cut by the gap is checked too
+
+	//Undo functions. The journal keeps the erased and inserted elements of every edit, not the
+	//data, the typing is coalesced. The oldest edits are forgotten when the journal takes more
+	//bytes than the budget. Clear forgets the history. The journal is created by EnableUndo
+	//and destroyed by DisableUndo, the buffer without undo doesn't allocate it.
+	void EnableUndo(const size_type& budget = undo_journal<T>::default_budget);
+	void DisableUndo() noexcept { if (side != nullptr) side->history.reset(); }
+	bool HasUndo() const noexcept { return Journal() != nullptr; }
+	bool CanUndo() const noexcept { return HasUndo() && Journal()->CanUndo(); }
+	bool CanRedo() const noexcept { return HasUndo() && Journal()->CanRedo(); }
+	bool Undo();                                                    //Returns false if there is nothing to undo
+	bool Redo();
+	size_type UndoMemory() const noexcept { return HasUndo() ? Journal()->Memory() : 0; } //Bytes taken by the journal
+
+	//Stats functions. The counters are kept only when GAPBUFFER_STATS is 1, otherwise they stay 0.
+	//The cache miss counter reads the hardware counter around every gap move, it's off by default.
+	gap_stats Stats() const noexcept { return stats.Get(capacity * sizeof(T)); }
+	void ResetStats() noexcept { stats.Reset(); }
+	bool SampleCacheMisses(bool enable = true) noexcept { return stats.SampleCacheMisses(enable); } //Returns false if the counter isn't available
+	std::string DumpStats() const { return StatsToJson(Stats(), GAPBUFFER_STATS != 0); }
 
 	//Range functions
 	const_iterator begin() const;
@@ -49,49 +200,1627 @@ class GapBuffer {
 	iterator end();
 
 	//operators
-	GapBuffer& operator=(const GapBuffer& rhs) { gap_start = rhs.gap_start; gap_end = rhs.gap_end; data = rhs.data; return *this; }
-	bool operator==(const GapBuffer& rhs) const { if (gap_start == rhs.gap_start && gap_end == rhs.gap_end && data == rhs.data) return true; else return false; }
-	bool operator!=(const GapBuffer& rhs) const { return !(*this == rhs); }
+	basic_gap_buffer& operator=(const basic_gap_buffer& rhs);
+	basic_gap_buffer& operator=(basic_gap_buffer&& rhs) noexcept;
+	bool operator==(const basic_gap_buffer& rhs) const;
+	bool operator!=(const basic_gap_buffer& rhs) const { return !(*this == rhs); }
 
-	//DEBUG
-	void setNewData(const std::string& str, size_type gap_s, size_type gap_e) {
-		Clear();
-		for (std::string::size_type i = 0; i < str.size(); ++i)
-			Insert(i, str[i]);
-
-		gap_start = gap_s;
-		gap_end = gap_e;
-	}
-	std::pair<size_t, size_t> getGapPos() {
-		return { gap_start, gap_end };
-	}
-	std::vector<char> getGapData() {
-		return data;
-	}
-	//
+	//Storage functions for the tests and the debugging. setNewData replaces the whole storage
+	//by the string of the same size, [gap_s, gap_e) of it becomes the gap. The history is
+	//forgotten and the indexes are rebuilt. getGapData gives the whole storage with the gap.
+	void setNewData(const std::basic_string<T>&, size_type gap_s, size_type gap_e);
+	std::pair<size_t, size_t> getGapPos() const noexcept { return { gap_start, gap_end }; }
+	std::vector<T, Alloc> getGapData() const { return { data, data + capacity, alloc }; }
 
   private:
 	void Move(size_type);
 	void GapMoveLeft(const size_type&);
 	void GapMoveRight(const size_type&);
-	void RemoveAt(const size_type&);                                //Remove a character by an index
-	void RemoveRange(const size_type&, const size_type&);           //Remove characters in the range of indexes
-	void ExpandStorage(const size_type&);
-	GapBuffer::iterator ConstIterToIter(GapBuffer::const_iterator); //Transform vector<char>::const_iterator to vector<char>::iterator
+	void RemoveAt(const size_type&);                                //Remove an element by an index
+	void RemoveRange(const size_type&, const size_type&);           //Remove elements in the range of indexes
+	void ReserveGap(const size_type&, const size_type&);            //Grow the storage until the gap fits the count, the grown gap is placed at the index
+	void Reallocate(const size_type&, const size_type&);            //Move the data to the storage of the new size with the gap at the index
+	size_type OpenGap(const size_type&, const size_type&, bool may_shift = true); //Storage position for the count of elements inserted at the index
+	void CommitInsert(const size_type&, const size_type&, const size_type&); //Index and record the elements written to the storage position
+	bool KeepsGap(const size_type&);                                //Record the edit index, true if the edit at it shouldn't move the gap
+	void ShrinkIfSparse();                                          //Apply the shrink policy after a removal
+	void Materialize();                                             //Copy the mapped file to the own storage
+	void MoveRange(pointer, const size_type&, const size_type&, T*) const; //Move the elements of the index range from the storage
+	iterator IterAt(const size_type&);                              //Iterator of the element index
+	bool Overlaps(const T*, const T*) const noexcept;               //The range is in the storage, the inserts copy it first
+
+	//Text index functions take the physical storage positions, the line separators and
+	//the code points are counted by chunks
+	static constexpr size_type index_chunk = 512;
+	void IndexText(const size_type&, const size_type&, const std::ptrdiff_t&); //Add or subtract the separators and the code points of the data range
+	void RebuildTextIndex();
+	size_type CountLines(const size_type&, const size_type&) const; //Separators in the range except the gap
+	size_type NthLineEnd(const size_type&, size_type) const;        //Physical position of the separator with the rank in the chunk
+	size_type CountCodePointStarts(const size_type&, const size_type&) const; //Code points in the range except the gap
+	size_type NthCodePoint(const size_type&, size_type) const;      //Physical position of the code point with the rank in the chunk
+	char ByteAt(const size_type& index) const noexcept { return AsByte(data[index < gap_start ? index : index + GapSize()]); }
+
+	//Undo journal functions, they do nothing if the journal isn't recording
+	undo_journal<T>* Journal() noexcept { return side != nullptr && side->history ? &*side->history : nullptr; }
+	const undo_journal<T>* Journal() const noexcept { return side != nullptr && side->history ? &*side->history : nullptr; }
+	bool IsRecording() const noexcept { return HasUndo() && Journal()->IsRecording(); }
+	void RecordRemoved(const size_type&, const size_type&);         //The range of indexes which is going to be removed
+	std::pair<segment, segment> RangeSegments(const size_type&, const size_type&) const; //Parts of the index range before and after the gap
+
+	//Storage functions. The whole storage is constructed, trivial types are left uninitialized.
+	pointer Allocate(const size_type&);
+	void Deallocate(pointer, const size_type&) noexcept;
+	pointer InlineData() noexcept { return std::launder(reinterpret_cast<pointer>(inline_storage)); }
+	const_pointer InlineData() const noexcept { return std::launder(reinterpret_cast<const_pointer>(inline_storage)); }
+	void StealStorage(basic_gap_buffer&) noexcept;                  //Take the storage of the object with the same allocator
+	void CopyStorage(const basic_gap_buffer&);                      //Copy the storage of the object with own allocator
+
+	//Opt-in state of the text indexes, the mapped file, the undo journal and the adaptive
+	//policy. It's allocated by Alloc when the first of them is used, so the plain buffer
+	//keeps only the storage, the policy and the pointer.
+	struct side_state {
+		fenwick_tree lines;                                         //Line separators of every storage chunk
+		bool has_line_index = false;
+		fenwick_tree code_points;                                   //Code points of every storage chunk
+		bool has_code_point_index = false;
+		file_mapping mapping;
+		std::optional<undo_journal<T>> history;                     //Exists while undo is enabled
+		edit_locality locality;                                     //Recent edits of the adaptive policy
+		size_type inserted_since_growth = 0;
+	};
+	using side_alloc = typename alloc_traits::template rebind_alloc<side_state>;
+	using side_traits = std::allocator_traits<side_alloc>;
+	side_state& Side();                                             //Allocate the state on the first use
+	void ReleaseSide() noexcept;
+
+	//Elements which the byte kernels can process
+	static constexpr bool is_byte_element = std::is_trivially_copyable_v<T> && sizeof(T) == 1;
+	static constexpr bool is_text_element = std::is_integral_v<T>;  //Elements which can be line separators
+	static const char* AsBytes(const T* ptr) noexcept { return reinterpret_cast<const char*>(ptr); }
+	static char AsByte(const T& item) noexcept { char byte; std::memcpy(&byte, &item, 1); return byte; }
+	static const T* FindElement(const T*, const T*, const T&);
+	static size_type CountElement(const T*, const T*, const T&);
+	static const T* SearchElements(const T*, const T*, segment);    //First needle in the range or the range end
+	static const T* SearchLastElements(const T*, const T*, segment); //Last needle in the range or the range end
+	std::vector<T> CopyRange(const size_type&, const size_type&) const; //Copy of the index range, it may cross the gap
+	static constexpr size_type block_size = std::max<size_type>(parallel_block / sizeof(T), 1); //Elements of the parallel block
+	size_type BlockCount() const { return (Size() + block_size - 1) / block_size; }
+	std::uint64_t HashBlock(const size_type&) const;
+	static void StoreMin(std::atomic<size_type>&, const size_type&) noexcept;
+	static replace_report Report(const size_type&, const size_type&, std::chrono::steady_clock::time_point); //Count and speed over the scanned elements
+
+	//Element algorithms, specialized for trivially copyable types
+	static void CopyElements(T*, T*, const size_type&);             //Copy to the left or to non-overlapping memory
+	static void CopyElementsBackward(T*, T*, const size_type&);     //Copy to the right, the ranges may overlap
+	static void FillElements(T*, const size_type&, const T&);
 
   private:
 	size_type gap_start;
 	size_type gap_end;
-	std::vector<char> data;
+	pointer data = nullptr;
+	size_type capacity = 0;
+	growth_policy policy;
+	[[no_unique_address]] allocator_type alloc;
+	side_state* side = nullptr;
+	[[no_unique_address]] stats_recorder<GAPBUFFER_STATS != 0> stats;
+	alignas(T) unsigned char inline_storage[inline_capacity == 0 ? 1 : inline_capacity * sizeof(T)];
 };
 
+using GapBuffer = basic_gap_buffer<char>;
+using PmrGapBuffer = basic_gap_buffer<char, std::pmr::polymorphic_allocator<char>>; //Buffer for memory resources like arenas and pools
+
+#include "iterator.h"
+#include "const_iterator.h"
+
 //Initialize GapBuffer from two iterators
 //New object doesn't include gap buffer in data
-template <typename It> GapBuffer::GapBuffer(It beg, It end) {
-	gap_start = gap_end = end - beg;
-	while (beg != end)
-		data.emplace_back(*beg++);
+template <class T, class Alloc>
+template <typename It> basic_gap_buffer<T, Alloc>::basic_gap_buffer(It beg, It end, const Alloc& a) : alloc(a) {
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+		capacity = static_cast<size_type>(std::distance(beg, end));
+		data = Allocate(capacity);
+		gap_start = gap_end = capacity;
+		std::copy(beg, end, data);
+	}
+	else {
+		//Single pass iterators can't be measured, the storage grows while they're read
+		data = Allocate(1);
+		capacity = 1;
+		gap_start = 0;
+		gap_end = 1;
+		for (; beg != end; ++beg)
+			Insert(Size(), *beg);
+	}
 }
 
-#endif
+//Recieve the path of the file. Empty file gives the empty buffer.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::FromFile(const std::filesystem::path& path, const Alloc& a) -> basic_gap_buffer {
+	static_assert(is_byte_element, "Only the buffers of bytes can map files.");
+	file_mapping file(path);
+	basic_gap_buffer result(a);
+	if (file.Size() == 0)
+		return result;
+
+	side_state& state = result.Side();
+	result.Deallocate(result.data, result.capacity);
+	state.mapping = std::move(file);
+	result.data = reinterpret_cast<pointer>(const_cast<char*>(state.mapping.Data()));
+	result.capacity = result.gap_start = result.gap_end = state.mapping.Size();
+	return result;
+}
+
+//Copy constructor copies the whole storage including the gap, so the copy
+//compares equal to the source.
+template <class T, class Alloc>
+basic_gap_buffer<T, Alloc>::basic_gap_buffer(const basic_gap_buffer& rhs)
+	: basic_gap_buffer(rhs, alloc_traits::select_on_container_copy_construction(rhs.alloc)) { }
+
+template <class T, class Alloc>
+basic_gap_buffer<T, Alloc>::basic_gap_buffer(const basic_gap_buffer& rhs, const Alloc& a)
+	: gap_start(0), gap_end(0), alloc(a) {
+	CopyStorage(rhs);
+}
+
+//Move constructor takes the storage, the source is left with an empty storage.
+template <class T, class Alloc>
+basic_gap_buffer<T, Alloc>::basic_gap_buffer(basic_gap_buffer&& rhs) noexcept
+	: gap_start(0), gap_end(0), alloc(std::move(rhs.alloc)) {
+	StealStorage(rhs);
+}
+
+//The storage can be taken only if the allocators are equal, otherwise it's copied.
+template <class T, class Alloc>
+basic_gap_buffer<T, Alloc>::basic_gap_buffer(basic_gap_buffer&& rhs, const Alloc& a)
+	: gap_start(0), gap_end(0), alloc(a) {
+	if (alloc == rhs.alloc)
+		StealStorage(rhs);
+	else
+		CopyStorage(rhs);
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::operator=(const basic_gap_buffer& rhs) -> basic_gap_buffer& {
+	if (this == &rhs)
+		return *this;
+
+	Deallocate(data, capacity);
+	ReleaseSide();
+	data = nullptr;
+	capacity = gap_start = gap_end = 0;
+	if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+		alloc = rhs.alloc;
+	CopyStorage(rhs);
+	return *this;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::operator=(basic_gap_buffer&& rhs) noexcept -> basic_gap_buffer& {
+	if (this == &rhs)
+		return *this;
+
+	Deallocate(data, capacity);
+	ReleaseSide();
+	data = nullptr;
+	capacity = gap_start = gap_end = 0;
+	if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+		alloc = std::move(rhs.alloc);
+		StealStorage(rhs);
+	}
+	else if (alloc == rhs.alloc)
+		StealStorage(rhs);
+	else
+		CopyStorage(rhs);
+	return *this;
+}
+
+//Recieve the object with the storage allocated by the equal allocator. Heap storage and
+//the side state are taken by the pointers, inline storage is copied. The source is left empty.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::StealStorage(basic_gap_buffer& rhs) noexcept {
+	gap_start = rhs.gap_start;
+	gap_end = rhs.gap_end;
+	capacity = rhs.capacity;
+	policy = rhs.policy;
+	side = std::exchange(rhs.side, nullptr);
+	if (rhs.IsInline()) {
+		data = InlineData();
+		std::memcpy(inline_storage, rhs.inline_storage, sizeof(inline_storage));
+	}
+	else
+		data = rhs.data;
+
+	rhs.data = nullptr;
+	rhs.capacity = rhs.gap_start = rhs.gap_end = 0;
+}
+
+//Recieve the object, its whole storage including the gap is copied to the storage
+//allocated by own allocator. The indexes and the journal are copied, the edit locality isn't.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::CopyStorage(const basic_gap_buffer& rhs) {
+	data = Allocate(rhs.capacity);
+	capacity = rhs.capacity;
+	std::copy(rhs.data, rhs.data + rhs.capacity, data);
+	gap_start = rhs.gap_start;
+	gap_end = rhs.gap_end;
+	policy = rhs.policy;
+	if (rhs.side != nullptr) {
+		side_state& state = Side();
+		state.lines = rhs.side->lines;
+		state.has_line_index = rhs.side->has_line_index;
+		state.code_points = rhs.side->code_points;
+		state.has_code_point_index = rhs.side->has_code_point_index;
+		state.history = rhs.side->history;
+	}
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Side() -> side_state& {
+	if (side == nullptr) {
+		side_alloc a(alloc);
+		side_state* state = side_traits::allocate(a, 1);
+		try {
+			side_traits::construct(a, state);
+		}
+		catch (...) {
+			side_traits::deallocate(a, state, 1);
+			throw;
+		}
+		side = state;
+	}
+	return *side;
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::ReleaseSide() noexcept {
+	if (side == nullptr)
+		return;
+
+	side_alloc a(alloc);
+	side_traits::destroy(a, side);
+	side_traits::deallocate(a, side, 1);
+	side = nullptr;
+}
+
+//Recieve the storage and the gap bounds in it, the gap must be inside the string. The new
+//storage is filled before the old one is freed.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::setNewData(const std::basic_string<T>& str, size_type gap_s, size_type gap_e) {
+	if (gap_s > gap_e || gap_e > str.size())
+		throw std::invalid_argument("Incorrect gap.");
+
+	pointer storage = Allocate(str.size());
+	try {
+		std::copy(std::cbegin(str), std::cend(str), storage);
+	}
+	catch (...) {
+		if (storage != data)
+			Deallocate(storage, str.size());
+		throw;
+	}
+	if (storage != data)
+		Deallocate(data, capacity);
+	data = storage;
+	capacity = str.size();
+	gap_start = gap_s;
+	gap_end = gap_e;
+	RebuildTextIndex();
+	if (side != nullptr) {
+		if (side->history)
+			side->history->Clear();
+		side->locality.Clear();
+	}
+}
+
+//Frees the storage and forgets the history, the indexes stay enabled and are rebuilt
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Clear() {
+	Deallocate(data, capacity);
+	data = nullptr;
+	capacity = 0;
+	data = Allocate(1);
+	capacity = 1;
+	gap_start = 0;
+	gap_end = 1;
+	RebuildTextIndex();
+	if (side != nullptr) {
+		if (side->history)
+			side->history->Clear();
+		side->locality.Clear();
+		side->inserted_since_growth = 0;
+	}
+}
+
+//Recieve the count of elements. Allocates the storage and constructs the elements,
+//for trivial types the default construction doesn't touch the memory.
+//The allocated size is the candidate of the peak storage in the stats.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Allocate(const size_type& count) -> pointer {
+	if (count == 0)
+		return nullptr;
+	if (count <= inline_capacity) {
+		stats.Storage(count * sizeof(T));
+		return InlineData();
+	}
+
+	pointer storage = alloc_traits::allocate(alloc, count);
+	if constexpr (!std::is_trivially_default_constructible_v<T>) {
+		try {
+			std::uninitialized_default_construct_n(storage, count);
+		}
+		catch (...) {
+			alloc_traits::deallocate(alloc, storage, count);
+			throw;
+		}
+	}
+	stats.Storage(count * sizeof(T));
+	return storage;
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Deallocate(pointer storage, const size_type& count) noexcept {
+	if (storage == nullptr || storage == InlineData())
+		return;
+	if (IsMapped() && static_cast<const void*>(storage) == side->mapping.Data()) {
+		side->mapping.Close();
+		return;
+	}
+
+	std::destroy_n(storage, count);
+	alloc_traits::deallocate(alloc, storage, count);
+}
+
+//Recieve the destination, the source and the count of elements. Trivially copyable
+//elements are copied with memmove, others are moved one by one from the left.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::CopyElements(T* dst, T* src, const size_type& count) {
+	if constexpr (std::is_trivially_copyable_v<T>)
+		std::memmove(dst, src, count * sizeof(T));
+	else
+		std::move(src, src + count, dst);
+}
+
+//Read CopyElements declaration, non trivial elements are moved from the right.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::CopyElementsBackward(T* dst, T* src, const size_type& count) {
+	if constexpr (std::is_trivially_copyable_v<T>)
+		std::memmove(dst, src, count * sizeof(T));
+	else
+		std::move_backward(src, src + count, dst + count);
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::FillElements(T* dst, const size_type& count, const T& item) {
+	if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 1)
+		std::memset(dst, static_cast<unsigned char>(item), count);
+	else
+		std::fill_n(dst, count, item);
+}
+
+//Recieve the range and the item. Returns the pointer to the first item or the range end.
+template <class T, class Alloc>
+const T* basic_gap_buffer<T, Alloc>::FindElement(const T* beg, const T* end, const T& item) {
+	if constexpr (is_byte_element)
+		return beg + (FindByte(AsBytes(beg), AsBytes(end), AsByte(item)) - AsBytes(beg));
+	else
+		return std::find(beg, end, item);
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::CountElement(const T* beg, const T* end, const T& item) -> size_type {
+	if constexpr (is_byte_element)
+		return CountByte(AsBytes(beg), AsBytes(end), AsByte(item));
+	else
+		return static_cast<size_type>(std::count(beg, end, item));
+}
+
+//Recieve the range and the needle, the byte needles are searched by the SIMD kernels
+template <class T, class Alloc>
+const T* basic_gap_buffer<T, Alloc>::SearchElements(const T* beg, const T* end, segment needle) {
+	if constexpr (is_byte_element)
+		return beg + (FindBytes(AsBytes(beg), AsBytes(end), AsBytes(needle.data()), needle.size()) - AsBytes(beg));
+	else
+		return std::search(beg, end, needle.begin(), needle.end());
+}
+
+//Recieve the range and the needle. There is no backward kernel, so the range is searched by
+//blocks from its end and the last match of the first block which has one is returned.
+template <class T, class Alloc>
+const T* basic_gap_buffer<T, Alloc>::SearchLastElements(const T* beg, const T* end, segment needle) {
+	if constexpr (!is_byte_element)
+		return std::find_end(beg, end, needle.begin(), needle.end());
+	else {
+		constexpr size_type block = 4096;
+		if (static_cast<size_type>(end - beg) < needle.size())
+			return end;
+
+		for (const T* starts_end = end - needle.size() + 1; starts_end != beg; ) {
+			const T* starts_beg = starts_end - std::min<size_type>(block, starts_end - beg);
+			const T* range_end = starts_end + needle.size() - 1;
+			const T* last = range_end;
+			for (const T* found = SearchElements(starts_beg, range_end, needle); found != range_end; found = SearchElements(found + 1, range_end, needle))
+				last = found;
+			if (last != range_end)
+				return last;
+			starts_end = starts_beg;
+		}
+		return end;
+	}
+}
+
+//Recieve the size of the new storage and the index of the gap in it. The new storage is
+//allocated once and the data before and after the index is moved to its beginning and
+//its end, so the gap is placed at the index without moving the data twice.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Reallocate(const size_type& new_size, const size_type& at) {
+	if (new_size > capacity)
+		stats.Expansion(new_size * sizeof(T));
+	pointer storage = Allocate(new_size);
+	if (storage == data) {
+		//Both storages are inline, only the data after the gap is moved, then the gap
+		const size_type tail = capacity - gap_end;
+		CopyElementsBackward(storage + new_size - tail, data + gap_end, tail);
+		capacity = new_size;
+		gap_end = new_size - tail;
+		RebuildTextIndex();
+		Move(at);
+		return;
+	}
+
+	const size_type tail = Size() - at;
+	MoveRange(data, 0, at, storage);
+	MoveRange(data, at, Size(), storage + new_size - tail);
+	Deallocate(data, capacity);
+	data = storage;
+	capacity = new_size;
+	gap_start = at;
+	gap_end = new_size - tail;
+	RebuildTextIndex();
+}
+
+//Recieve the count of elements which are going to be inserted and the index of the gap. If the
+//gap is too small the storage grows geometrically in one reallocation. The adaptive policy
+//grows it by the inserts since the last growth including this one, so the insert which
+//fills the empty buffer gets the gap of min_gap. 1/16 of the data keeps the copies amortized.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::ReserveGap(const size_type& count, const size_type& index) {
+	if (GapSize() >= count)
+		return;
+
+	auto grown = static_cast<size_type>(static_cast<double>(capacity) * policy.factor);
+	if (policy.adaptive) {
+		side_state& state = Side();
+		grown = std::min(grown, Size() + std::max(2 * state.inserted_since_growth, Size() / 16));
+		state.inserted_since_growth = 0;
+	}
+	Reallocate(std::max(grown, Size() + count + policy.min_gap), index);
+}
+
+//Recieve the index and the count of elements which are going to be inserted. Returns the
+//storage position for them. Usually the gap is moved to the index and the elements are written
+//to its start. When the gap is kept, the data between the gap and the index is shifted by
+//count instead and the gap shrinks, so it stays where the next edit is expected.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::OpenGap(const size_type& index, const size_type& count, bool may_shift) -> size_type {
+	const bool shift = KeepsGap(index) && may_shift;
+	if (policy.adaptive)
+		Side().inserted_since_growth += count;
+	ReserveGap(count, shift ? gap_start : index);
+	if (!shift) {
+		Move(index);
+		return gap_start;
+	}
+
+	Materialize();
+	if (index < gap_start) {
+		const size_type moved = gap_start - index;
+		IndexText(index, gap_start, -1);
+		CopyElementsBackward(data + index + count, data + index, moved);
+		gap_start += count;
+		IndexText(index + count, gap_start, 1);
+		stats.Shifted(moved * sizeof(T));
+		return index;
+	}
+
+	const size_type pos = index + GapSize();
+	const size_type moved = pos - gap_end;
+	IndexText(gap_end, pos, -1);
+	CopyElements(data + gap_end - count, data + gap_end, moved);
+	gap_end -= count;
+	IndexText(gap_end, pos - count, 1);
+	stats.Shifted(moved * sizeof(T));
+	return pos - count;
+}
+
+//Recieve the index, the storage position and the count of the elements which are written there
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::CommitInsert(const size_type& index, const size_type& pos, const size_type& count) {
+	IndexText(pos, pos + count, 1);
+	if (pos == gap_start)
+		gap_start += count;
+	if (IsRecording())
+		Journal()->RecordInsert(index, segment(data + pos, count));
+}
+
+//Recieve the index of the edit. The gap is kept when the edits ping-pong and it's at the hot
+//spot of the previous edit, where the next one is expected. The shift moves the data once
+//instead of twice, only trivially copyable elements are shifted, their writes don't throw.
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::KeepsGap(const size_type& index) {
+	if (!std::is_trivially_copyable_v<T> || !policy.adaptive)
+		return false;
+
+	edit_locality& locality = Side().locality;
+	locality.Record(index);
+	return locality.IsPingPong() && edit_locality::Distance(locality.Recent(1), gap_start) <= edit_locality::hot_spot_size
+		&& edit_locality::Distance(index, gap_start) > edit_locality::hot_spot_size;
+}
+
+//Shrinks the storage when the shrink policy is on and the gap is too big after a removal
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::ShrinkIfSparse() {
+	if (policy.shrink_threshold <= 0.0 || GapSize() <= policy.min_gap)
+		return;
+	if (static_cast<double>(GapSize()) <= policy.shrink_threshold * static_cast<double>(capacity))
+		return;
+
+	const auto shrunk = static_cast<size_type>(static_cast<double>(Size()) * policy.factor);
+	const auto new_size = std::max(shrunk, Size() + policy.min_gap);
+	if (new_size < capacity)
+		Reallocate(new_size, gap_start);
+}
+
+//Recieve the edits sorted by offset, they must not overlap. The new storage is filled
+//from the left in one pass: the data between the edits is moved, the erased data is
+//skipped and the texts are copied. The gap is left after the last text, where the typing
+//goes on. Returns the index after the text of every edit in the new data. The texts may
+//be taken from the buffer itself. Non trivial elements are copied instead of moved, so
+//the buffer and its history are unchanged if the rebuild throws.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::BatchEdit(std::span<const edit> edits) -> std::vector<size_type> {
+	size_type new_size = Size();
+	size_type edited_end = 0;
+	for (const edit& change : edits) {
+		if (change.offset < edited_end || change.offset > Size() || change.erase_count > Size() - change.offset)
+			throw std::invalid_argument("Incorrect edits.");
+		edited_end = change.offset + change.erase_count;
+		new_size = new_size - change.erase_count + change.text.size();
+	}
+
+	std::vector<size_type> carets;
+	carets.reserve(edits.size());
+	if (edits.empty())
+		return carets;
+
+	//The erased data is saved for the history before the rebuild, the records are
+	//written after it succeeds
+	std::vector<std::vector<T>> erased;
+	if (IsRecording()) {
+		erased.reserve(edits.size());
+		for (const edit& change : edits)
+			erased.push_back(CopyRange(change.offset, change.offset + change.erase_count));
+	}
+
+	const size_type new_capacity = std::max(capacity, new_size + policy.min_gap);
+	pointer storage = Allocate(new_capacity);
+	if (new_capacity > capacity)
+		stats.Expansion(new_capacity * sizeof(T));
+
+	//Inline storage is rebuilt in place from its copy, the texts taken from it are read
+	//from the copy too
+	alignas(T) unsigned char saved[sizeof(inline_storage)];
+	pointer source = data;
+	if (storage == data) {
+		std::memcpy(saved, inline_storage, sizeof(saved));
+		source = reinterpret_cast<pointer>(saved);
+	}
+	auto text_of = [&](const edit& change) -> segment {
+		if (source == data || !Overlaps(change.text.data(), change.text.data() + change.text.size()))
+			return change.text;
+		return { source + (change.text.data() - data), change.text.size() };
+	};
+	auto keep = [&](const size_type& beg, const size_type& end, T* dst) {
+		if constexpr (std::is_trivially_copyable_v<T>)
+			MoveRange(source, beg, end, dst);
+		else {
+			const auto [first, second] = RangeSegments(beg, end);
+			std::copy(std::begin(second), std::end(second), std::copy(std::begin(first), std::end(first), dst));
+		}
+	};
+
+	size_type out = 0;
+	size_type in = 0;
+	const size_type tail = Size() - edited_end;
+	try {
+		for (const edit& change : edits) {
+			keep(in, change.offset, storage + out);
+			out += change.offset - in;
+			const segment text = text_of(change);
+			std::copy(std::begin(text), std::end(text), storage + out);
+			out += text.size();
+			carets.push_back(out);
+			in = change.offset + change.erase_count;
+		}
+		keep(in, Size(), storage + new_capacity - tail);
+	}
+	catch (...) {
+		if (storage != data)
+			Deallocate(storage, new_capacity);
+		throw;
+	}
+
+	if (storage != data)
+		Deallocate(data, capacity);
+	data = storage;
+	capacity = new_capacity;
+	gap_start = out;
+	gap_end = new_capacity - tail;
+	RebuildTextIndex();
+
+	//Every edit is recorded at its offset in the data edited by the previous ones,
+	//the edits are undone together from the last one. The texts are read from the new data.
+	for (size_type i = 0; i < erased.size(); ++i) {
+		const size_type length = edits[i].text.size();
+		const size_type offset = carets[i] - length;
+		Journal()->RecordEdit(offset, erased[i], segment(), segment(data + offset, length), i != 0);
+	}
+	return carets;
+}
+
+//Recieve the pattern and the replacement. All matches are found over the segments first,
+//then the data is rebuilt once by BatchEdit, so the gap stays after the last replacement.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ReplaceAll(segment pattern, segment replacement) -> replace_report {
+	const auto start = std::chrono::steady_clock::now();
+	const size_type scanned = Size();
+	std::vector<edit> edits;
+	if (!pattern.empty()) {
+		const std::vector<size_type> matches = FindAll(pattern);
+		edits.reserve(matches.size());
+		for (const size_type& offset : matches)
+			edits.push_back({ offset, pattern.size(), replacement });
+		BatchEdit(edits);
+	}
+	return Report(edits.size(), scanned, start);
+}
+
+//Recieve the regex and the format of the replacement. std::regex needs one range, so the
+//matches are searched through the iterators which cross the gap. The formatted texts are
+//kept in one storage, the edits point into it after all matches are formatted.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ReplaceAll(const std::basic_regex<T>& pattern, segment format) -> replace_report {
+	const auto start = std::chrono::steady_clock::now();
+	const size_type scanned = Size();
+	std::vector<T> texts;
+	std::vector<size_type> text_ends;
+	std::vector<edit> edits;
+	for (std::regex_iterator<const_iterator, T> it(std::cbegin(*this), std::cend(*this), pattern), last; it != last; ++it) {
+		it->format(std::back_inserter(texts), format.data(), format.data() + format.size());
+		edits.push_back({ static_cast<size_type>(it->position()), static_cast<size_type>(it->length()), segment() });
+		text_ends.push_back(texts.size());
+	}
+	for (size_type i = 0, text_start = 0; i < edits.size(); text_start = text_ends[i++])
+		edits[i].text = segment(texts.data() + text_start, text_ends[i] - text_start);
+	BatchEdit(edits);
+	return Report(edits.size(), scanned, start);
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Report(const size_type& count, const size_type& scanned, std::chrono::steady_clock::time_point start) -> replace_report {
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return { count, elapsed.count() > 0.0 ? static_cast<double>(scanned * sizeof(T)) / elapsed.count() / 1e6 : 0.0 };
+}
+
+//Recieve the storage with the current gap, the range of indexes and the destination
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::MoveRange(pointer source, const size_type& beg, const size_type& end, T* dst) const {
+	if (beg < gap_start) {
+		const size_type count = std::min(end, gap_start) - beg;
+		CopyElements(dst, source + beg, count);
+		dst += count;
+	}
+	if (end > gap_start) {
+		const size_type from = std::max(beg, gap_start);
+		CopyElements(dst, source + from + GapSize(), end - from);
+	}
+}
+
+//The mapped file is read-only and has no gap. It's copied once to the storage of the
+//same size, the mapping is closed by Deallocate. Inserts do the same by growing the gap.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Materialize() {
+	if (IsMapped())
+		Reallocate(capacity, gap_start);
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::SaveTo(int fd) const {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be saved.");
+	const auto [before, after] = Segments();
+	WriteSegments(fd, std::as_bytes(before), std::as_bytes(after));
+}
+
+//Recieve the path and the options. By default the temporary file is renamed over the
+//target, so the target is either old or completely saved.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::SaveTo(const std::filesystem::path& path, const save_options& options) const {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be saved.");
+	const auto [before, after] = Segments();
+	SaveSegments(path, std::as_bytes(before), std::as_bytes(after), options);
+}
+
+//Recieve the new policy, factor less than 1 can't grow the storage.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::SetGrowthPolicy(const growth_policy& new_policy) {
+	if (new_policy.factor < 1.0 || new_policy.shrink_threshold < 0.0 || new_policy.shrink_threshold >= 1.0)
+		throw std::invalid_argument("Incorrect growth policy.");
+
+	policy = new_policy;
+}
+
+//Recieve the index of the element, Size() gives the end. The iterator points to the
+//storage position of the index, as the iterator shifts do.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::IterAt(const size_type& index) -> iterator {
+	return { data, data + capacity, data + (index < gap_start ? index : index + GapSize()), &gap_start, &gap_end };
+}
+
+//Recieve the range of elements. The pointers to the unrelated objects are compared by std::less.
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::Overlaps(const T* beg, const T* end) const noexcept {
+	const std::less<const T*> less;
+	return beg != end && less(beg, data + capacity) && less(data, end);
+}
+
+//Recieve a move position index. Move a gap buffer to a match position.
+//It uses a logic to move buffer to the left.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::GapMoveLeft(const size_type& index) {
+	const size_type count = gap_start - index;
+	IndexText(index, gap_start, -1);
+	CopyElementsBackward(data + gap_end - count, data + index, count);
+	stats.MovedLeft(count * sizeof(T));
+	gap_end -= count;
+	gap_start = index;
+	IndexText(gap_end, gap_end + count, 1);
+}
+
+//Recieve a move position index. Move a gap buffer to a match position.
+//It uses a logic to move buffer to the right.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::GapMoveRight(const size_type& index) {
+	const size_type count = index - gap_end;
+	IndexText(gap_end, index, -1);
+	CopyElements(data + gap_start, data + gap_end, count);
+	stats.MovedRight(count * sizeof(T));
+	IndexText(gap_start, gap_start + count, 1);
+	gap_start += count;
+	gap_end = index;
+}
+
+//Recieve the index and element. It inserts the element in the index position.
+//The element of the buffer itself is copied before the gap is opened.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Insert(const size_type& index, const T& item) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+	if (Overlaps(&item, &item + 1)) {
+		const T copy = item;
+		return Insert(index, copy);
+	}
+
+	const size_type pos = OpenGap(index, 1);
+	data[pos] = item;
+	CommitInsert(index, pos, 1);
+}
+
+//Recieve the const_iterator and element. It inserts the element before the iterator position.
+//Returns nothing because iterator cannot points to the gap buffer.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Insert(const_iterator pos, const T& item) {
+	Insert(static_cast<size_type>(pos - std::cbegin(*this)), item);
+}
+
+//Recieve the index and the range of elements. Capacity is checked and the gap is moved
+//only once for the whole range, then the elements are copied in a single pass. The range
+//of the buffer itself is copied first, opening the gap moves or frees it.
+template <class T, class Alloc>
+template <typename It, typename> void basic_gap_buffer<T, Alloc>::Insert(const size_type& index, It first, It last) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+
+	if constexpr (std::is_same_v<It, iterator> || std::is_same_v<It, const_iterator>) {
+		if (first != last && first.data_beg == data) {
+			const std::vector<T> items(first, last);
+			return Insert(index, segment(items));
+		}
+	}
+	else if constexpr (std::contiguous_iterator<It>) {
+		if (first != last && Overlaps(std::to_address(first), std::to_address(first) + (last - first))) {
+			const std::vector<T> items(first, last);
+			return Insert(index, segment(items));
+		}
+	}
+
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+		const auto count = static_cast<size_type>(std::distance(first, last));
+		if (count == 0)
+			return;
+
+		//The iterators may throw, so the data isn't shifted before they are read
+		const size_type pos = OpenGap(index, count, false);
+		std::copy(first, last, data + pos);
+		CommitInsert(index, pos, count);
+	}
+	else {
+		//Single pass iterators are read once to count them
+		const std::vector<T> items(first, last);
+		Insert(index, segment(items));
+	}
+}
+
+//Recieve the index and the contiguous elements. The gap is moved once and the elements
+//are copied with a single memcpy when they are trivially copyable. The elements of the
+//buffer itself are copied first, opening the gap moves or frees them.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Insert(const size_type& index, segment items) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+	if (items.empty())
+		return;
+	if (Overlaps(items.data(), items.data() + items.size())) {
+		const std::vector<T> copy(std::begin(items), std::end(items));
+		return Insert(index, segment(copy));
+	}
+
+	const size_type pos = OpenGap(index, items.size());
+	if constexpr (std::is_trivially_copyable_v<T>)
+		std::memcpy(data + pos, items.data(), items.size() * sizeof(T));
+	else
+		std::copy(std::begin(items), std::end(items), data + pos);
+	CommitInsert(index, pos, items.size());
+}
+
+//Recieve the index, count and element. It inserts count copies of the element in the index position.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Insert(const size_type& index, const size_type& count, const T& item) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+	if (count == 0)
+		return;
+	if (Overlaps(&item, &item + 1)) {
+		const T copy = item;
+		return Insert(index, count, copy);
+	}
+
+	const size_type pos = OpenGap(index, count);
+	FillElements(data + pos, count, item);
+	CommitInsert(index, pos, count);
+}
+
+//Recieve the const_iterator which points to the element in data, remove this element.
+//Returns the iterator points to the next element, it's made from the index of the removed
+//element, so the iterator is never left in the gap.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Erase(const_iterator to_del) -> iterator {
+	const auto index = static_cast<size_type>(to_del - std::cbegin(*this));
+	RemoveAt(index);
+	return IterAt(index);
+}
+
+//Recieve the iterator which points to the element in data, remove this element.
+//Returns the iterator points to the next element.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Erase(iterator to_del) -> iterator {
+	const auto index = static_cast<size_type>(to_del - begin());
+	RemoveAt(index);
+	return IterAt(index);
+}
+
+//Recieve the iterator range, remove elements in the range [).
+//Returns the iterator points to the next element after the last deleted.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Erase(iterator beg, iterator end) -> iterator {
+	const auto index = static_cast<size_type>(beg - begin());
+	RemoveRange(index, static_cast<size_type>(end - begin()));
+	return IterAt(index);
+}
+
+//Recieve the const_iterator range, remove elements in the range [).
+//Returns the iterator points to the next element after the last deleted.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Erase(const_iterator beg, const_iterator end) -> iterator {
+	const auto index = static_cast<size_type>(beg - std::cbegin(*this));
+	RemoveRange(index, static_cast<size_type>(end - std::cbegin(*this)));
+	return IterAt(index);
+}
+
+//Recieve the index of the element which we want gap buffer to be moved.
+//Source word element index. The storage isn't grown here, the inserting
+//functions reserve the gap before the move.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::Move(size_type index) {
+	if (index > Size())
+		throw std::invalid_argument("Incorrect index.");
+
+	stats.MoveCall();
+	if (index >= gap_start)
+		index += GapSize();
+
+	//Buffer is already here
+	if (index == gap_end)
+		return;
+
+	Materialize();
+
+	const auto sample = stats.StartMove();
+	if (index < gap_start)
+		GapMoveLeft(index);
+
+	else
+		GapMoveRight(index);
+	stats.FinishMove(sample);
+
+	return;
+}
+
+//Recieves the index of element(without gap) and removes it by removal
+//of the gap buffer.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::RemoveAt(const size_type& index) {
+	if (index >= Size())
+		throw std::invalid_argument("Incorrect index.");
+
+	RemoveRange(index, index + 1);
+}
+
+//Recieves the range of the elements by the indexes and remove it. The gap isn't positioned
+//before the removal, the erased elements are never moved: the range which touches the gap
+//is joined to it without moves, so the backspaces, the deletes and the ranges over the gap
+//only change its bounds. The mapped file is copied before, so the gap isn't opened in it.
+//Otherwise the data between the gap and the range is moved once.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::RemoveRange(const size_type& beg, const size_type& end) {
+	if (beg > end || end > Size())
+		throw std::invalid_argument("Incorrect index.");
+
+	RecordRemoved(beg, end);
+	const size_type count = end - beg;
+	const bool keep = KeepsGap(beg);
+	if (beg <= gap_start && end >= gap_start) {
+		Materialize();
+		const size_type after = end - gap_start;
+		IndexText(beg, gap_start, -1);
+		IndexText(gap_end, gap_end + after, -1);
+		gap_start = beg;
+		gap_end += after;
+	}
+	else if (!keep && end < gap_start) {
+		Move(end);
+		IndexText(beg, end, -1);
+		gap_start = beg;
+	}
+	else if (!keep) {
+		Move(beg);
+		IndexText(gap_end, gap_end + count, -1);
+		gap_end += count;
+	}
+	//The data between the range and the gap is shifted over the range, the gap grows in place
+	else if (end < gap_start) {
+		Materialize();
+		IndexText(beg, gap_start, -1);
+		CopyElements(data + beg, data + end, gap_start - end);
+		gap_start -= count;
+		IndexText(beg, gap_start, 1);
+		stats.Shifted((gap_start - beg) * sizeof(T));
+	}
+	else {
+		Materialize();
+		const size_type pos = beg + GapSize();
+		IndexText(gap_end, pos + count, -1);
+		CopyElementsBackward(data + gap_end + count, data + gap_end, pos - gap_end);
+		gap_end += count;
+		IndexText(gap_end, pos + count, 1);
+		stats.Shifted((pos - gap_end + count) * sizeof(T));
+	}
+	ShrinkIfSparse();
+}
+
+//Recieve the range of indexes which is going to be removed
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::RecordRemoved(const size_type& beg, const size_type& end) {
+	if (!IsRecording() || beg == end)
+		return;
+
+	const auto [first, second] = RangeSegments(beg, end);
+	Journal()->RecordErase(beg, first, second);
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::RangeSegments(const size_type& beg, const size_type& end) const -> std::pair<segment, segment> {
+	const auto [before, after] = Segments();
+	const size_type split = std::clamp(gap_start, beg, end);
+	return { beg < gap_start ? before.subspan(beg, split - beg) : segment(), end > gap_start ? after.subspan(split - gap_start, end - split) : segment() };
+}
+
+//Recieve the memory budget of the journal in bytes. The journal is created on the first call,
+//the next calls only change the budget.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::EnableUndo(const size_type& budget) {
+	std::optional<undo_journal<T>>& history = Side().history;
+	if (!history)
+		history.emplace();
+	history->Enable(budget);
+}
+
+//Recieve nothing. The records of the last group are applied backward: the inserted elements
+//are removed and the erased ones are inserted back. Only the edited ranges are moved.
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::Undo() {
+	if (!CanUndo())
+		return false;
+
+	undo_journal<T>& history = *Journal();
+	typename undo_journal<T>::replay_guard guard(history);
+	bool joined = true;
+	while (joined) {
+		const auto& change = history.NextUndo();
+		RemoveRange(change.offset, change.offset + change.inserted.size());
+		Insert(change.offset, segment(change.erased));
+		joined = change.joined;
+	}
+	return true;
+}
+
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::Redo() {
+	if (!CanRedo())
+		return false;
+
+	undo_journal<T>& history = *Journal();
+	typename undo_journal<T>::replay_guard guard(history);
+	do {
+		const auto& change = history.NextRedo();
+		RemoveRange(change.offset, change.offset + change.erased.size());
+		Insert(change.offset, segment(change.inserted));
+	} while (history.RedoJoined());
+	return true;
+}
+
+//Returns the data before the gap and the data after the gap, together
+//they are the whole content. Nothing is copied or moved.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Segments() const noexcept -> std::pair<segment, segment> {
+	return { segment(data, gap_start), segment(data + gap_end, capacity - gap_end) };
+}
+
+//Recieve the item and the start index. The data before the gap and the data after
+//it are searched separately, the gap is not moved.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Find(const T& item, size_type pos) const -> size_type {
+	if (pos < gap_start) {
+		const T* found = FindElement(data + pos, data + gap_start, item);
+		if (found != data + gap_start)
+			return static_cast<size_type>(found - data);
+		pos = gap_start;
+	}
+	if (pos >= Size())
+		return npos;
+
+	const T* found = FindElement(data + pos + GapSize(), data + capacity, item);
+	return found != data + capacity ? static_cast<size_type>(found - data) - GapSize() : npos;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Count(const T& item) const -> size_type {
+	return CountElement(data, data + gap_start, item) + CountElement(data + gap_end, data + capacity, item);
+}
+
+//Recieve the needle and the start index. The data before the gap and the data after it are
+//searched in place. The matches which cross the gap are searched in the copy of the last
+//needle size - 1 items before the gap and the first ones after it, the gap is not moved.
+//The copy is shorter than two needles, so every match in it crosses the gap.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::Find(segment needle, size_type pos) const -> size_type {
+	const size_type size = Size();
+	if (pos > size || needle.size() > size - pos)
+		return npos;
+	if (needle.empty())
+		return pos;
+
+	if (pos < gap_start) {
+		const T* found = SearchElements(data + pos, data + gap_start, needle);
+		if (found != data + gap_start)
+			return static_cast<size_type>(found - data);
+	}
+
+	const size_type tail = needle.size() - 1;
+	if (tail != 0 && pos < gap_start && gap_start != size) {
+		const size_type beg = std::max(pos, gap_start - std::min(gap_start, tail));
+		const std::vector<T> window = CopyRange(beg, std::min(size, gap_start + tail));
+		const T* found = SearchElements(window.data(), window.data() + window.size(), needle);
+		if (found != window.data() + window.size())
+			return beg + static_cast<size_type>(found - window.data());
+	}
+
+	pos = std::max(pos, gap_start);
+	const T* found = SearchElements(data + pos + GapSize(), data + capacity, needle);
+	return found != data + capacity ? static_cast<size_type>(found - data) - GapSize() : npos;
+}
+
+//Recieve the needle and the last start index. The parts are searched in the backward order,
+//the ranges are cut so the matches can't start after pos.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::RFind(segment needle, size_type pos) const -> size_type {
+	const size_type size = Size();
+	if (needle.size() > size)
+		return npos;
+	const size_type limit = std::min(pos, size - needle.size());
+	if (needle.empty())
+		return limit;
+
+	if (limit >= gap_start) {
+		const T* beg = data + gap_end;
+		const T* end = beg + (limit - gap_start) + needle.size();
+		const T* found = SearchLastElements(beg, end, needle);
+		if (found != end)
+			return static_cast<size_type>(found - data) - GapSize();
+	}
+
+	const size_type tail = needle.size() - 1;
+	if (tail != 0 && gap_start != 0 && gap_start != size && limit + tail >= gap_start) {
+		const size_type beg = gap_start - std::min(gap_start, tail);
+		const std::vector<T> window = CopyRange(beg, std::min({ size, gap_start + tail, limit + needle.size() }));
+		const T* found = SearchLastElements(window.data(), window.data() + window.size(), needle);
+		if (found != window.data() + window.size())
+			return beg + static_cast<size_type>(found - window.data());
+	}
+
+	const T* end = data + std::min(gap_start, limit + needle.size());
+	const T* found = SearchLastElements(data, end, needle);
+	return found != end ? static_cast<size_type>(found - data) : npos;
+}
+
+//The search goes on after the end of every match, so the matches don't overlap
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::FindAll(segment needle) const -> std::vector<size_type> {
+	std::vector<size_type> result;
+	if (needle.empty())
+		return result;
+	for (size_type pos = Find(needle); pos != npos; pos = Find(needle, pos + needle.size()))
+		result.push_back(pos);
+	return result;
+}
+
+//Blocks after the found item are skipped, the blocks are taken in the order of the data
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ParallelFind(const T& item, size_type threads) const -> size_type {
+	std::atomic<size_type> found = npos;
+	ParallelFor(BlockCount(), threads, [&](std::size_t block) {
+		const size_type beg = block * block_size;
+		if (beg > found.load(std::memory_order_relaxed))
+			return;
+		const auto [first, second] = RangeSegments(beg, std::min(Size(), beg + block_size));
+		const T* in_first = FindElement(first.data(), first.data() + first.size(), item);
+		if (in_first != first.data() + first.size())
+			return StoreMin(found, beg + static_cast<size_type>(in_first - first.data()));
+		const T* in_second = FindElement(second.data(), second.data() + second.size(), item);
+		if (in_second != second.data() + second.size())
+			StoreMin(found, beg + first.size() + static_cast<size_type>(in_second - second.data()));
+	});
+	return found;
+}
+
+//Every block searches the matches which start in it, so its range goes on for needle size - 1
+//items. The ranges which cross the gap are copied, there are at most two of them.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ParallelFind(segment needle, size_type threads) const -> size_type {
+	if (needle.size() > Size())
+		return npos;
+	if (needle.empty())
+		return 0;
+
+	std::atomic<size_type> found = npos;
+	ParallelFor(BlockCount(), threads, [&](std::size_t block) {
+		const size_type beg = block * block_size;
+		if (beg > found.load(std::memory_order_relaxed))
+			return;
+		const size_type end = std::min(Size(), beg + block_size + needle.size() - 1);
+		const auto [first, second] = RangeSegments(beg, end);
+		if (!first.empty() && !second.empty()) {
+			const std::vector<T> window = CopyRange(beg, end);
+			const T* in_window = SearchElements(window.data(), window.data() + window.size(), needle);
+			if (in_window != window.data() + window.size())
+				StoreMin(found, beg + static_cast<size_type>(in_window - window.data()));
+			return;
+		}
+		const segment range = first.empty() ? second : first;
+		const T* in_range = SearchElements(range.data(), range.data() + range.size(), needle);
+		if (in_range != range.data() + range.size())
+			StoreMin(found, beg + static_cast<size_type>(in_range - range.data()));
+	});
+	return found;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ParallelCount(const T& item, size_type threads) const -> size_type {
+	std::atomic<size_type> count = 0;
+	ParallelFor(BlockCount(), threads, [&](std::size_t block) {
+		const auto [first, second] = RangeSegments(block * block_size, std::min(Size(), (block + 1) * block_size));
+		count.fetch_add(CountElement(first.data(), first.data() + first.size(), item) + CountElement(second.data(), second.data() + second.size(), item), std::memory_order_relaxed);
+	});
+	return count;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ParallelLineCount(size_type threads) const -> size_type {
+	return ParallelCount(T('\n'), threads) + 1;
+}
+
+//The blocks are cut by the index, so the hash doesn't depend on the gap position
+template <class T, class Alloc>
+std::uint64_t basic_gap_buffer<T, Alloc>::Hash() const {
+	std::uint64_t hash = 0;
+	for (size_type block = 0; block < BlockCount(); ++block)
+		hash = CombineHashes(hash, HashBlock(block));
+	return hash;
+}
+
+template <class T, class Alloc>
+std::uint64_t basic_gap_buffer<T, Alloc>::ParallelHash(size_type threads) const {
+	std::vector<std::uint64_t> hashes(BlockCount());
+	ParallelFor(hashes.size(), threads, [&](std::size_t block) { hashes[block] = HashBlock(block); });
+	std::uint64_t hash = 0;
+	for (const std::uint64_t& block_hash : hashes)
+		hash = CombineHashes(hash, block_hash);
+	return hash;
+}
+
+//The block which crosses the gap is copied, so the hash sees the same bytes as without the gap
+template <class T, class Alloc>
+std::uint64_t basic_gap_buffer<T, Alloc>::HashBlock(const size_type& block) const {
+	static_assert(std::is_trivially_copyable_v<T>, "Hash reads the bytes of the elements.");
+	const size_type beg = block * block_size;
+	const size_type end = std::min(Size(), beg + block_size);
+	const auto [first, second] = RangeSegments(beg, end);
+	if (!first.empty() && !second.empty()) {
+		const std::vector<T> copy = CopyRange(beg, end);
+		return HashBytes(AsBytes(copy.data()), copy.size() * sizeof(T));
+	}
+	const segment range = first.empty() ? second : first;
+	return HashBytes(AsBytes(range.data()), range.size() * sizeof(T));
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::StoreMin(std::atomic<size_type>& target, const size_type& value) noexcept {
+	size_type current = target.load(std::memory_order_relaxed);
+	while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+}
+
+template <class T, class Alloc>
+std::vector<T> basic_gap_buffer<T, Alloc>::CopyRange(const size_type& beg, const size_type& end) const {
+	const auto [first, second] = RangeSegments(beg, end);
+	std::vector<T> result;
+	result.reserve(end - beg);
+	result.insert(result.end(), first.begin(), first.end());
+	result.insert(result.end(), second.begin(), second.end());
+	return result;
+}
+
+//Recieve the physical range of the data and the sign. The separators and the code points
+//of every chunk touched by the range are added to the indexes or subtracted from them.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::IndexText(const size_type& beg, const size_type& end, const std::ptrdiff_t& sign) {
+	if constexpr (is_text_element) {
+		if (!HasLineIndex() && !HasCodePointIndex())
+			return;
+
+		for (size_type pos = beg; pos < end;) {
+			const size_type chunk = pos / index_chunk;
+			const size_type chunk_end = std::min(end, (chunk + 1) * index_chunk);
+			if (side->has_line_index) {
+				const size_type count = CountElement(data + pos, data + chunk_end, T('\n'));
+				if (count != 0)
+					side->lines.Add(chunk, sign * static_cast<std::ptrdiff_t>(count));
+			}
+			if constexpr (is_byte_element) {
+				if (side->has_code_point_index)
+					side->code_points.Add(chunk, sign * static_cast<std::ptrdiff_t>(CountCodePoints(AsBytes(data + pos), AsBytes(data + chunk_end))));
+			}
+			pos = chunk_end;
+		}
+	}
+}
+
+//Counts the separators and the code points of every storage chunk, it's O(n) like the storage copy
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::RebuildTextIndex() {
+	if constexpr (is_text_element) {
+		if (side == nullptr)
+			return;
+
+		const size_type chunks = (capacity + index_chunk - 1) / index_chunk;
+		if (side->has_line_index) {
+			std::vector<std::size_t> counts(chunks);
+			for (size_type chunk = 0; chunk < chunks; ++chunk)
+				counts[chunk] = CountLines(chunk * index_chunk, std::min(capacity, (chunk + 1) * index_chunk));
+			side->lines.Assign(std::move(counts));
+		}
+		if constexpr (is_byte_element) {
+			if (side->has_code_point_index) {
+				std::vector<std::size_t> counts(chunks);
+				for (size_type chunk = 0; chunk < chunks; ++chunk)
+					counts[chunk] = CountCodePointStarts(chunk * index_chunk, std::min(capacity, (chunk + 1) * index_chunk));
+				side->code_points.Assign(std::move(counts));
+			}
+		}
+	}
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::CountLines(const size_type& beg, const size_type& end) const -> size_type {
+	size_type count = 0;
+	if (beg < gap_start)
+		count += CountElement(data + beg, data + std::min(end, gap_start), T('\n'));
+	if (end > gap_end)
+		count += CountElement(data + std::max(beg, gap_end), data + end, T('\n'));
+	return count;
+}
+
+//Recieve the chunk and the rank of the separator inside it starting from 1. The parts
+//of the chunk before and after the gap are searched.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::NthLineEnd(const size_type& chunk, size_type rank) const -> size_type {
+	const size_type chunk_beg = chunk * index_chunk;
+	const size_type chunk_end = std::min(capacity, chunk_beg + index_chunk);
+	const std::pair<size_type, size_type> parts[] = { { chunk_beg, std::min(chunk_end, gap_start) }, { std::max(chunk_beg, gap_end), chunk_end } };
+	for (auto [pos, end] : parts) {
+		for (; pos < end; ++pos) {
+			pos = static_cast<size_type>(FindElement(data + pos, data + end, T('\n')) - data);
+			if (pos != end && --rank == 0)
+				return pos;
+		}
+	}
+	return chunk_end;
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::EnableLineIndex(bool enable) {
+	static_assert(is_text_element, "Line index needs integral elements.");
+	if (!enable && side != nullptr) {
+		side->lines.Clear();
+		side->has_line_index = false;
+	}
+	else if (enable && !HasLineIndex()) {
+		Side().has_line_index = true;
+		RebuildTextIndex();
+	}
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::LineCount() const -> size_type {
+	static_assert(is_text_element, "Lines need integral elements.");
+	return (HasLineIndex() ? side->lines.Total() : Count(T('\n'))) + 1;
+}
+
+//Recieve the line. Line 0 starts at 0, the others start after their separators.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::OffsetOfLine(const size_type& line) const -> size_type {
+	if (line >= LineCount())
+		throw std::out_of_range("Line is out of range.");
+	if (line == 0)
+		return 0;
+
+	if (!HasLineIndex()) {
+		size_type pos = npos;
+		for (size_type i = 0; i < line; ++i)
+			pos = Find(T('\n'), pos + 1);
+		return pos + 1;
+	}
+
+	size_type rank = line;
+	const size_type chunk = side->lines.Find(rank);
+	const size_type pos = NthLineEnd(chunk, rank);
+	return (pos < gap_start ? pos : pos - GapSize()) + 1;
+}
+
+//Recieve the element index, the size is allowed and belongs to the last line.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::LineColOf(const size_type& index) const -> std::pair<size_type, size_type> {
+	if (index > Size())
+		throw std::out_of_range("Index is out of range.");
+
+	const size_type pos = index < gap_start ? index : index + GapSize();
+	size_type line;
+	if (HasLineIndex()) {
+		const size_type chunk = pos / index_chunk;
+		line = side->lines.PrefixSum(chunk) + CountLines(chunk * index_chunk, pos);
+	}
+	else
+		line = CountLines(0, pos);
+
+	return { line, index - OffsetOfLine(line) };
+}
+
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::EnableCodePointIndex(bool enable) {
+	static_assert(is_byte_element, "UTF-8 needs 1-byte elements.");
+	if (!enable && side != nullptr) {
+		side->code_points.Clear();
+		side->has_code_point_index = false;
+	}
+	else if (enable && !HasCodePointIndex()) {
+		Side().has_code_point_index = true;
+		RebuildTextIndex();
+	}
+}
+
+//Recieve the byte index. A code point is at most 4 bytes, so at most 3 continuation bytes are skipped.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::NextCodePoint(const size_type& index) const -> size_type {
+	static_assert(is_byte_element, "UTF-8 needs 1-byte elements.");
+	if (index >= Size())
+		return Size();
+	size_type pos = index + 1;
+	for (int i = 0; i < 3 && pos < Size() && IsContinuationByte(ByteAt(pos)); ++i)
+		++pos;
+	return pos;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::PrevCodePoint(const size_type& index) const -> size_type {
+	static_assert(is_byte_element, "UTF-8 needs 1-byte elements.");
+	if (index == 0)
+		return 0;
+	size_type pos = std::min(index, Size()) - 1;
+	for (int i = 0; i < 3 && pos > 0 && IsContinuationByte(ByteAt(pos)); ++i)
+		--pos;
+	return pos;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::CodePointCount() const -> size_type {
+	static_assert(is_byte_element, "UTF-8 needs 1-byte elements.");
+	return HasCodePointIndex() ? side->code_points.Total() : CountCodePointStarts(0, capacity);
+}
+
+//Recieve the number of the code point. The index finds its chunk in O(log n), without
+//the index the chunks are counted from the start.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::OffsetOfCodePoint(const size_type& number) const -> size_type {
+	const size_type count = CodePointCount();
+	if (number > count)
+		throw std::out_of_range("Code point is out of range.");
+	if (number == count)
+		return Size();
+
+	size_type rank = number + 1;
+	size_type chunk = 0;
+	if (HasCodePointIndex())
+		chunk = side->code_points.Find(rank);
+	else {
+		for (size_type in_chunk; rank > (in_chunk = CountCodePointStarts(chunk * index_chunk, std::min(capacity, (chunk + 1) * index_chunk))); ++chunk)
+			rank -= in_chunk;
+	}
+	const size_type pos = NthCodePoint(chunk, rank);
+	return pos < gap_start ? pos : pos - GapSize();
+}
+
+//Recieve the byte index, the size is allowed
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::CodePointsBefore(const size_type& index) const -> size_type {
+	static_assert(is_byte_element, "UTF-8 needs 1-byte elements.");
+	if (index > Size())
+		throw std::out_of_range("Index is out of range.");
+
+	const size_type pos = index < gap_start ? index : index + GapSize();
+	if (!HasCodePointIndex())
+		return CountCodePointStarts(0, pos);
+	const size_type chunk = pos / index_chunk;
+	return side->code_points.PrefixSum(chunk) + CountCodePointStarts(chunk * index_chunk, pos);
+}
+
+//The segments are validated by the kernel. If the first one ends with a cut sequence,
+//it's checked in the copy with the first bytes after the gap and the second segment
+//is validated after the rest of that sequence.
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::IsValidUtf8() const {
+	static_assert(is_byte_element, "UTF-8 needs 1-byte elements.");
+	const auto [before, after] = Segments();
+	const char* first_end = AsBytes(before.data() + before.size());
+	const char* second = AsBytes(after.data());
+	const char* second_end = second + after.size();
+	const char* invalid = ValidateUtf8(AsBytes(before.data()), first_end);
+	if (invalid != first_end) {
+		const std::size_t cut = static_cast<std::size_t>(first_end - invalid);
+		if (cut > 3)
+			return false;
+		char window[4];
+		std::memcpy(window, invalid, cut);
+		const std::size_t taken = std::min<std::size_t>(4 - cut, after.size());
+		if (taken != 0)
+			std::memcpy(window + cut, second, taken);
+		const std::size_t size = Utf8SequenceSize(window, window + cut + taken);
+		if (size <= cut)
+			return false;
+		second += size - cut;
+	}
+	return ValidateUtf8(second, second_end) == second_end;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::CountCodePointStarts(const size_type& beg, const size_type& end) const -> size_type {
+	size_type count = 0;
+	if (beg < gap_start)
+		count += CountCodePoints(AsBytes(data + beg), AsBytes(data + std::min(end, gap_start)));
+	if (end > gap_end)
+		count += CountCodePoints(AsBytes(data + std::max(beg, gap_end)), AsBytes(data + end));
+	return count;
+}
+
+//Recieve the chunk and the rank of the code point inside it starting from 1
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::NthCodePoint(const size_type& chunk, size_type rank) const -> size_type {
+	const size_type chunk_beg = chunk * index_chunk;
+	const size_type chunk_end = std::min(capacity, chunk_beg + index_chunk);
+	const std::pair<size_type, size_type> parts[] = { { chunk_beg, std::min(chunk_end, gap_start) }, { std::max(chunk_beg, gap_end), chunk_end } };
+	for (auto [pos, end] : parts)
+		for (; pos < end; ++pos)
+			if (!IsContinuationByte(AsByte(data[pos])) && --rank == 0)
+				return pos;
+	return chunk_end;
+}
+
+//Buffers are equal if their gaps are at the same place and the whole storages are equal
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::operator==(const basic_gap_buffer& rhs) const {
+	if (gap_start != rhs.gap_start || gap_end != rhs.gap_end || capacity != rhs.capacity)
+		return false;
+	if constexpr (is_byte_element)
+		return capacity == 0 || Mismatch(AsBytes(data), AsBytes(rhs.data), capacity) == capacity;
+	else
+		return std::equal(data, data + capacity, rhs.data);
+}
+
+//Moves the gap to the end of the storage if it's not there yet, so the whole
+//content is one contiguous segment.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::ContiguousView() -> segment {
+	if (!IsGapEmpty() && gap_end != capacity)
+		Move(Size());
+
+	return { data, Size() };
+}
 
+//Method delegate responsible for iterator::ptr initialization not in a gap to an appropriate constructor
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::begin() const -> const_iterator {
+	return { data, data + capacity, data, const_cast<size_type*>(&gap_start), const_cast<size_type*>(&gap_end) };
+}
+
+//The end const_iterator::ptr points to the element after the last real element.
+//Iterators never point into the gap, so it is the end of the storage whatever
+//the gap position is.
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::end() const -> const_iterator {
+	return { data, data + capacity, data + capacity, const_cast<size_type*>(&gap_start), const_cast<size_type*>(&gap_end) };
+}
+
+//The iterator gives the writable elements, so the mapped file is copied to the own storage first
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::begin() -> iterator {
+	Materialize();
+	return { data, data + capacity, data, &gap_start, &gap_end };
+}
+
+//Read end() const and begin() declarations
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::end() -> iterator {
+	Materialize();
+	return { data, data + capacity, data + capacity, &gap_start, &gap_end };
+}
+
+//The char buffer is compiled once in GapBuffer.cpp
+extern template class basic_gap_buffer<char>;
+
+#endif
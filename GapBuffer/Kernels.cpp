@@ -0,0 +1,412 @@
+#include "Kernels.h"
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GAPBUFFER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define GAPBUFFER_X86 0
+#endif
+
+//MSVC compiles the intrinsics without target flags, GCC and Clang need the function attribute
+#if GAPBUFFER_X86 && (defined(__GNUC__) || defined(__clang__))
+#define GAPBUFFER_TARGET_SSE2 __attribute__((target("sse2")))
+#define GAPBUFFER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define GAPBUFFER_TARGET_SSE2
+#define GAPBUFFER_TARGET_AVX2
+#endif
+
+namespace {
+
+//Portable kernels. Counting is done by 8-byte words with the zero byte trick.
+//memchr is used as the search kernel of every level, libc already vectorizes it
+//and it's faster than the hand-written loops.
+const char* PortableFindByte(const char* beg, const char* end, char value) {
+	const void* found = beg == end ? nullptr : std::memchr(beg, value, static_cast<std::size_t>(end - beg));
+	return found ? static_cast<const char*>(found) : end;
+}
+
+std::size_t PortableCountByte(const char* beg, const char* end, char value) {
+	constexpr std::uint64_t ones = 0x0101010101010101ull;
+	constexpr std::uint64_t highs = 0x8080808080808080ull;
+	const std::uint64_t pattern = ones * static_cast<unsigned char>(value);
+	std::size_t count = 0;
+	for (; end - beg >= 8; beg += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, beg, 8);
+		word ^= pattern;
+		//High bit of every zero byte, without carries between the bytes
+		const std::uint64_t zeros = ~(((word & ~highs) + ~highs) | word) & highs;
+		std::uint64_t bits = zeros >> 7;
+		bits += bits >> 32;
+		bits += bits >> 16;
+		bits += bits >> 8;
+		count += bits & 0xFF;
+	}
+	for (; beg != end; ++beg)
+		count += *beg == value;
+	return count;
+}
+
+std::size_t PortableMismatch(const char* lhs, const char* rhs, std::size_t count) {
+	std::size_t i = 0;
+	for (; count - i >= 8; i += 8) {
+		std::uint64_t a, b;
+		std::memcpy(&a, lhs + i, 8);
+		std::memcpy(&b, rhs + i, 8);
+		if (a != b)
+			break;
+	}
+	for (; i < count; ++i)
+		if (lhs[i] != rhs[i])
+			return i;
+	return count;
+}
+
+//Horspool search, the shift is taken by the haystack byte under the needle end
+const char* PortableFindBytes(const char* beg, const char* end, const char* needle, std::size_t size) {
+	if (size == 0)
+		return beg;
+	if (static_cast<std::size_t>(end - beg) < size)
+		return end;
+	if (size == 1)
+		return PortableFindByte(beg, end, *needle);
+
+	std::size_t shift[256];
+	std::fill(std::begin(shift), std::end(shift), size);
+	for (std::size_t i = 0; i + 1 < size; ++i)
+		shift[static_cast<unsigned char>(needle[i])] = size - 1 - i;
+
+	const char last = needle[size - 1];
+	for (const char* pos = beg; static_cast<std::size_t>(end - pos) >= size; pos += shift[static_cast<unsigned char>(pos[size - 1])])
+		if (pos[size - 1] == last && std::memcmp(pos, needle, size - 1) == 0)
+			return pos;
+	return end;
+}
+
+//Continuation bytes have the high bit and don't have the next one
+std::size_t PortableCountCodePoints(const char* beg, const char* end) {
+	constexpr std::uint64_t highs = 0x8080808080808080ull;
+	const std::size_t size = static_cast<std::size_t>(end - beg);
+	std::size_t continuations = 0;
+	for (; end - beg >= 8; beg += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, beg, 8);
+		std::uint64_t bits = ((word & ~(word << 1)) & highs) >> 7;
+		bits += bits >> 32;
+		bits += bits >> 16;
+		bits += bits >> 8;
+		continuations += bits & 0xFF;
+	}
+	for (; beg != end; ++beg)
+		continuations += IsContinuationByte(*beg);
+	return size - continuations;
+}
+
+const char* PortableValidateUtf8(const char* beg, const char* end) {
+	constexpr std::uint64_t highs = 0x8080808080808080ull;
+	while (beg != end) {
+		if (end - beg >= 8) {
+			std::uint64_t word;
+			std::memcpy(&word, beg, 8);
+			if ((word & highs) == 0) {
+				beg += 8;
+				continue;
+			}
+		}
+		const std::size_t size = Utf8SequenceSize(beg, end);
+		if (size == 0)
+			return beg;
+		beg += size;
+	}
+	return end;
+}
+
+#if GAPBUFFER_X86
+inline unsigned TrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+//Matches are accumulated as -1 in 8-bit counters, they're summed up before the counters overflow
+GAPBUFFER_TARGET_SSE2 std::size_t Sse2CountByte(const char* beg, const char* end, char value) {
+	const __m128i pattern = _mm_set1_epi8(value);
+	const __m128i zero = _mm_setzero_si128();
+	std::size_t count = 0;
+	while (end - beg >= 16) {
+		__m128i counters = _mm_setzero_si128();
+		for (int i = 0; i < 255 && end - beg >= 16; ++i, beg += 16) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+			counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, pattern));
+		}
+		const __m128i sums = _mm_sad_epu8(counters, zero);
+		count += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) + static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+	}
+	for (; beg != end; ++beg)
+		count += *beg == value;
+	return count;
+}
+
+GAPBUFFER_TARGET_SSE2 std::size_t Sse2Mismatch(const char* lhs, const char* rhs, std::size_t count) {
+	std::size_t i = 0;
+	for (; count - i >= 16; i += 16) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) ^ 0xFFFFu;
+		if (mask != 0)
+			return i + TrailingZeros(mask);
+	}
+	for (; i < count; ++i)
+		if (lhs[i] != rhs[i])
+			return i;
+	return count;
+}
+
+//The positions where both the first and the last bytes of the needle match are compared
+//with memcmp, so the text rarely gets to memcmp
+GAPBUFFER_TARGET_SSE2 const char* Sse2FindBytes(const char* beg, const char* end, const char* needle, std::size_t size) {
+	if (size < 2 || static_cast<std::size_t>(end - beg) < size + 15)
+		return PortableFindBytes(beg, end, needle, size);
+
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[size - 1]);
+	const char* pos = beg;
+	for (; static_cast<std::size_t>(end - pos) >= size + 15; pos += 16) {
+		const __m128i heads = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)), first);
+		const __m128i tails = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + size - 1)), last);
+		for (unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(heads, tails))); mask != 0; mask &= mask - 1) {
+			const char* candidate = pos + TrailingZeros(mask);
+			if (std::memcmp(candidate + 1, needle + 1, size - 2) == 0)
+				return candidate;
+		}
+	}
+	return PortableFindBytes(pos, end, needle, size);
+}
+
+//Bytes greater than 0xBF as signed ones aren't continuation bytes
+GAPBUFFER_TARGET_SSE2 std::size_t Sse2CountCodePoints(const char* beg, const char* end) {
+	const __m128i bound = _mm_set1_epi8(static_cast<char>(0xBF));
+	const __m128i zero = _mm_setzero_si128();
+	std::size_t count = 0;
+	while (end - beg >= 16) {
+		__m128i counters = _mm_setzero_si128();
+		for (int i = 0; i < 255 && end - beg >= 16; ++i, beg += 16) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+			counters = _mm_sub_epi8(counters, _mm_cmpgt_epi8(block, bound));
+		}
+		const __m128i sums = _mm_sad_epu8(counters, zero);
+		count += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) + static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+	}
+	return count + PortableCountCodePoints(beg, end);
+}
+
+//Blocks without the high bits are ASCII and valid, the other sequences are checked one by one
+GAPBUFFER_TARGET_SSE2 const char* Sse2ValidateUtf8(const char* beg, const char* end) {
+	while (end - beg >= 16) {
+		if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(beg))) == 0) {
+			beg += 16;
+			continue;
+		}
+		const char* block_end = beg + 16;
+		while (beg < block_end) {
+			const std::size_t size = Utf8SequenceSize(beg, end);
+			if (size == 0)
+				return beg;
+			beg += size;
+		}
+	}
+	return PortableValidateUtf8(beg, end);
+}
+
+//AVX2 kernels clear the upper halves of the registers before the SSE2 tail,
+//otherwise the legacy SSE code pays the state transition penalty.
+GAPBUFFER_TARGET_AVX2 std::size_t Avx2CountByte(const char* beg, const char* end, char value) {
+	const __m256i pattern = _mm256_set1_epi8(value);
+	const __m256i zero = _mm256_setzero_si256();
+	std::size_t count = 0;
+	while (end - beg >= 32) {
+		__m256i counters = _mm256_setzero_si256();
+		for (int i = 0; i < 255 && end - beg >= 32; ++i, beg += 32) {
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(beg));
+			counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(block, pattern));
+		}
+		std::uint64_t sums[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), _mm256_sad_epu8(counters, zero));
+		count += static_cast<std::size_t>(sums[0] + sums[1] + sums[2] + sums[3]);
+	}
+	_mm256_zeroupper();
+	return count + Sse2CountByte(beg, end, value);
+}
+
+GAPBUFFER_TARGET_AVX2 std::size_t Avx2Mismatch(const char* lhs, const char* rhs, std::size_t count) {
+	std::size_t i = 0;
+	for (; count - i >= 32; i += 32) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+		const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+		if (mask != 0)
+			return i + TrailingZeros(mask);
+	}
+	_mm256_zeroupper();
+	return i + Sse2Mismatch(lhs + i, rhs + i, count - i);
+}
+
+GAPBUFFER_TARGET_AVX2 const char* Avx2FindBytes(const char* beg, const char* end, const char* needle, std::size_t size) {
+	if (size < 2 || static_cast<std::size_t>(end - beg) < size + 31)
+		return Sse2FindBytes(beg, end, needle, size);
+
+	const __m256i first = _mm256_set1_epi8(needle[0]);
+	const __m256i last = _mm256_set1_epi8(needle[size - 1]);
+	const char* pos = beg;
+	for (; static_cast<std::size_t>(end - pos) >= size + 31; pos += 32) {
+		const __m256i heads = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos)), first);
+		const __m256i tails = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + size - 1)), last);
+		for (unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(heads, tails))); mask != 0; mask &= mask - 1) {
+			const char* candidate = pos + TrailingZeros(mask);
+			if (std::memcmp(candidate + 1, needle + 1, size - 2) == 0) {
+				_mm256_zeroupper();
+				return candidate;
+			}
+		}
+	}
+	_mm256_zeroupper();
+	return Sse2FindBytes(pos, end, needle, size);
+}
+
+GAPBUFFER_TARGET_AVX2 std::size_t Avx2CountCodePoints(const char* beg, const char* end) {
+	const __m256i bound = _mm256_set1_epi8(static_cast<char>(0xBF));
+	const __m256i zero = _mm256_setzero_si256();
+	std::size_t count = 0;
+	while (end - beg >= 32) {
+		__m256i counters = _mm256_setzero_si256();
+		for (int i = 0; i < 255 && end - beg >= 32; ++i, beg += 32) {
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(beg));
+			counters = _mm256_sub_epi8(counters, _mm256_cmpgt_epi8(block, bound));
+		}
+		std::uint64_t sums[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), _mm256_sad_epu8(counters, zero));
+		count += static_cast<std::size_t>(sums[0] + sums[1] + sums[2] + sums[3]);
+	}
+	_mm256_zeroupper();
+	return count + Sse2CountCodePoints(beg, end);
+}
+
+GAPBUFFER_TARGET_AVX2 const char* Avx2ValidateUtf8(const char* beg, const char* end) {
+	while (end - beg >= 32) {
+		if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(beg))) == 0) {
+			beg += 32;
+			continue;
+		}
+		const char* block_end = beg + 32;
+		while (beg < block_end) {
+			const std::size_t size = Utf8SequenceSize(beg, end);
+			if (size == 0) {
+				_mm256_zeroupper();
+				return beg;
+			}
+			beg += size;
+		}
+	}
+	_mm256_zeroupper();
+	return Sse2ValidateUtf8(beg, end);
+}
+
+bool CpuSupportsAvx2() noexcept {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+	__cpuidex(info, 7, 0);
+	return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+const byte_kernels portable_kernels = { simd_level::portable, PortableFindByte, PortableCountByte, PortableMismatch, PortableFindBytes, PortableCountCodePoints, PortableValidateUtf8 };
+#if GAPBUFFER_X86
+const byte_kernels sse2_kernels = { simd_level::sse2, PortableFindByte, Sse2CountByte, Sse2Mismatch, Sse2FindBytes, Sse2CountCodePoints, Sse2ValidateUtf8 };
+const byte_kernels avx2_kernels = { simd_level::avx2, PortableFindByte, Avx2CountByte, Avx2Mismatch, Avx2FindBytes, Avx2CountCodePoints, Avx2ValidateUtf8 };
+#endif
+
+}
+
+//Well-formed sequences of the Unicode standard: no overlong forms, no surrogates, not above U+10FFFF
+std::size_t Utf8SequenceSize(const char* beg, const char* end) noexcept {
+	const auto lead = static_cast<unsigned char>(*beg);
+	if (lead < 0x80)
+		return 1;
+
+	std::size_t size;
+	unsigned char low = 0x80, high = 0xBF;                          //Range of the second byte
+	if (lead >= 0xC2 && lead <= 0xDF)
+		size = 2;
+	else if (lead >= 0xE0 && lead <= 0xEF) {
+		size = 3;
+		if (lead == 0xE0)
+			low = 0xA0;
+		else if (lead == 0xED)
+			high = 0x9F;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4) {
+		size = 4;
+		if (lead == 0xF0)
+			low = 0x90;
+		else if (lead == 0xF4)
+			high = 0x8F;
+	}
+	else
+		return 0;
+
+	if (static_cast<std::size_t>(end - beg) < size)
+		return 0;
+	const auto second = static_cast<unsigned char>(beg[1]);
+	if (second < low || second > high)
+		return 0;
+	for (std::size_t i = 2; i < size; ++i)
+		if (!IsContinuationByte(beg[i]))
+			return 0;
+	return size;
+}
+
+simd_level DetectSimdLevel() noexcept {
+#if GAPBUFFER_X86
+	return CpuSupportsAvx2() ? simd_level::avx2 : simd_level::sse2;
+#else
+	return simd_level::portable;
+#endif
+}
+
+const byte_kernels& ByteKernels() noexcept {
+	static const byte_kernels& detected = ByteKernels(DetectSimdLevel());
+	return detected;
+}
+
+const byte_kernels& ByteKernels(simd_level level) noexcept {
+#if GAPBUFFER_X86
+	if (level == simd_level::avx2)
+		return DetectSimdLevel() == simd_level::avx2 ? avx2_kernels : sse2_kernels;
+	if (level == simd_level::sse2)
+		return sse2_kernels;
+#else
+	(void)level;
+#endif
+	return portable_kernels;
+}
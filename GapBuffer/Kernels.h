@@ -0,0 +1,59 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+
+//Byte kernels used by the buffers of 1-byte elements. Every kernel has the portable
+//version and x86 SSE2 and AVX2 versions, the best one supported by the CPU is chosen
+//once at runtime. Gap moves and the byte search use memmove and memchr, libc
+//already dispatches them by the CPU. The substring search checks the first and the last
+//bytes of the needle at 16 or 32 positions at once, the portable one is Horspool.
+//UTF-8 kernels count the bytes which aren't continuation bytes 10xxxxxx, and validate
+//the text skipping the ASCII blocks at once and checking the other sequences one by one.
+enum class simd_level { portable, sse2, avx2 };
+
+struct byte_kernels {
+	simd_level level;
+	const char* (*find_byte)(const char* beg, const char* end, char value);      //First value in [beg, end) or end
+	std::size_t (*count_byte)(const char* beg, const char* end, char value);     //Count of value in [beg, end)
+	std::size_t (*mismatch)(const char* lhs, const char* rhs, std::size_t count); //Index of the first difference or count
+	const char* (*find_bytes)(const char* beg, const char* end, const char* needle, std::size_t size); //First needle in [beg, end) or end
+	std::size_t (*count_code_points)(const char* beg, const char* end);         //Code point starts in [beg, end)
+	const char* (*validate_utf8)(const char* beg, const char* end);            //Start of the first invalid or cut sequence or end
+};
+
+simd_level DetectSimdLevel() noexcept;                           //The best level supported by the CPU
+const byte_kernels& ByteKernels() noexcept;                      //Kernels of the detected level
+const byte_kernels& ByteKernels(simd_level) noexcept;            //Kernels of the level, unsupported level falls back to the detected one
+
+inline const char* FindByte(const char* beg, const char* end, char value) noexcept {
+	return ByteKernels().find_byte(beg, end, value);
+}
+
+inline std::size_t CountByte(const char* beg, const char* end, char value) noexcept {
+	return ByteKernels().count_byte(beg, end, value);
+}
+
+inline const char* FindBytes(const char* beg, const char* end, const char* needle, std::size_t size) noexcept {
+	return ByteKernels().find_bytes(beg, end, needle, size);
+}
+
+inline std::size_t CountCodePoints(const char* beg, const char* end) noexcept {
+	return ByteKernels().count_code_points(beg, end);
+}
+
+inline const char* ValidateUtf8(const char* beg, const char* end) noexcept {
+	return ByteKernels().validate_utf8(beg, end);
+}
+
+inline bool IsContinuationByte(char byte) noexcept {
+	return (static_cast<unsigned char>(byte) & 0xC0) == 0x80;
+}
+
+std::size_t Utf8SequenceSize(const char* beg, const char* end) noexcept; //Bytes of the valid sequence at beg or 0
+
+inline std::size_t Mismatch(const char* lhs, const char* rhs, std::size_t count) noexcept {
+	return ByteKernels().mismatch(lhs, rhs, count);
+}
+
+#endif
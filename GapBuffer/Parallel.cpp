@@ -0,0 +1,88 @@
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint64_t prime_one = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t prime_two = 0xC2B2AE3D27D4EB4Full;
+
+inline std::uint64_t RotateLeft(std::uint64_t value, int shift) noexcept {
+	return (value << shift) | (value >> (64 - shift));
+}
+
+inline std::uint64_t Mix(std::uint64_t hash, std::uint64_t word) noexcept {
+	return RotateLeft(hash ^ (word * prime_two), 31) * prime_one;
+}
+
+}
+
+std::size_t ParallelThreads(std::size_t threads) noexcept {
+	if (threads != 0)
+		return threads;
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(std::size_t count, std::size_t threads, const std::function<void(std::size_t)>& fn) {
+	std::atomic<std::size_t> next = 0;
+	std::exception_ptr error;
+	std::mutex error_mutex;
+	auto worker = [&] {
+		for (std::size_t index = next.fetch_add(1, std::memory_order_relaxed); index < count; index = next.fetch_add(1, std::memory_order_relaxed)) {
+			try {
+				fn(index);
+			}
+			catch (...) {
+				const std::lock_guard lock(error_mutex);
+				if (!error)
+					error = std::current_exception();
+				next.store(count, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	const std::size_t helpers = std::min(ParallelThreads(threads), count) - (count != 0);
+	pool.reserve(helpers);
+	for (std::size_t i = 0; i < helpers; ++i)
+		pool.emplace_back(worker);
+	worker();
+	for (std::thread& thread : pool)
+		thread.join();
+	if (error)
+		std::rethrow_exception(error);
+}
+
+//Four independent lanes of 8-byte words, so the multiplications don't wait for each other
+std::uint64_t HashBytes(const char* data, std::size_t size) noexcept {
+	std::uint64_t lanes[4] = { prime_one, prime_two, ~prime_one, ~prime_two };
+	std::size_t i = 0;
+	for (; size - i >= 32; i += 32) {
+		for (int lane = 0; lane < 4; ++lane) {
+			std::uint64_t word;
+			std::memcpy(&word, data + i + lane * 8, 8);
+			lanes[lane] = Mix(lanes[lane], word);
+		}
+	}
+	std::uint64_t hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+	for (; size - i >= 8; i += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		hash = Mix(hash, word);
+	}
+	std::uint64_t tail = 0;
+	if (i != size)
+		std::memcpy(&tail, data + i, size - i);
+	hash = Mix(hash, tail ^ (static_cast<std::uint64_t>(size) << 56));
+	hash ^= hash >> 33;
+	return hash * prime_two;
+}
+
+std::uint64_t CombineHashes(std::uint64_t seed, std::uint64_t hash) noexcept {
+	return Mix(seed, hash);
+}
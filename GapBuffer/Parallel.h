@@ -0,0 +1,23 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+//Parallel scans of the big buffers. The data is split into blocks which fit into L2, the
+//threads take the next free block from the shared counter, so a thread which is done with
+//its block takes another one and the slow blocks don't hold the others. Blocks are taken
+//in the order of the data, so the search can skip the blocks after the found item.
+constexpr std::size_t parallel_block = 256 << 10;                //Block size in bytes
+
+std::size_t ParallelThreads(std::size_t threads) noexcept;        //0 is the count of the hardware threads
+//Call fn for every block index from 0 to count on the threads, the caller is one of them.
+//The first exception of fn is thrown after all threads are finished.
+void ParallelFor(std::size_t count, std::size_t threads, const std::function<void(std::size_t)>& fn);
+
+//Hash of the bytes, the hashes of the blocks are combined in their order
+std::uint64_t HashBytes(const char* data, std::size_t size) noexcept;
+std::uint64_t CombineHashes(std::uint64_t seed, std::uint64_t hash) noexcept;
+
+#endif
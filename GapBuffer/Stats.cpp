@@ -0,0 +1,88 @@
+#include "Stats.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::string StatsToJson(const gap_stats& stats, bool enabled) {
+	std::string json = "{\"enabled\":";
+	json += enabled ? "true" : "false";
+	auto field = [&json](const char* name, std::uint64_t value) {
+		json += ",\"";
+		json += name;
+		json += "\":";
+		json += std::to_string(value);
+	};
+	field("move_calls", stats.move_calls);
+	field("gap_moves", stats.gap_moves);
+	field("bytes_moved_left", stats.bytes_moved_left);
+	field("bytes_moved_right", stats.bytes_moved_right);
+	field("shifts", stats.shifts);
+	field("bytes_shifted", stats.bytes_shifted);
+	field("expansions", stats.expansions);
+	field("expansion_bytes", stats.expansion_bytes);
+	field("peak_storage_bytes", stats.peak_storage_bytes);
+	json += ",\"cache_miss_sampling\":";
+	json += stats.cache_miss_sampling ? "true" : "false";
+	field("sampled_moves", stats.sampled_moves);
+	field("cache_misses", stats.cache_misses);
+
+	//Every bucket is the smallest distance of its moves and their count
+	json += ",\"move_distances\":[";
+	bool first = true;
+	for (std::size_t i = 0; i < stats.move_distances.size(); ++i) {
+		if (stats.move_distances[i] == 0)
+			continue;
+		json += first ? "{\"min_bytes\":" : ",{\"min_bytes\":";
+		json += std::to_string(std::uint64_t(1) << i);
+		json += ",\"count\":";
+		json += std::to_string(stats.move_distances[i]);
+		json += '}';
+		first = false;
+	}
+	json += "]}";
+	return json;
+}
+
+#ifdef __linux__
+//The counter of the user space misses of the calling thread on any CPU
+bool cache_miss_counter::Open() noexcept {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	const long result = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+	fd = result < 0 ? -1 : static_cast<int>(result);
+	return IsOpen();
+}
+
+std::uint64_t cache_miss_counter::Read() const noexcept {
+	std::uint64_t value = 0;
+	if (::read(fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+		return 0;
+	return value;
+}
+
+void cache_miss_counter::Close() noexcept {
+	if (fd != -1)
+		::close(fd);
+	fd = -1;
+}
+#else
+bool cache_miss_counter::Open() noexcept {
+	return false;
+}
+
+std::uint64_t cache_miss_counter::Read() const noexcept {
+	return 0;
+}
+
+void cache_miss_counter::Close() noexcept {
+}
+#endif
@@ -0,0 +1,122 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//Hot path instrumentation of the gap buffer. Define GAPBUFFER_STATS to 1 to compile the
+//counters in, by default the recorder is empty and its calls are removed by the compiler,
+//so the buffer has the same size and code as without it.
+#ifndef GAPBUFFER_STATS
+#define GAPBUFFER_STATS 0
+#endif
+
+//Counters of one buffer, the sizes are in bytes. Distances of the gap moves are counted by
+//powers of 2: the bucket i has the moves of [2^i, 2^(i+1)) bytes.
+struct gap_stats {
+	static constexpr std::size_t distance_buckets = 48;
+	std::uint64_t move_calls = 0;                                   //Calls of Move, including the ones which found the gap in place
+	std::uint64_t gap_moves = 0;                                    //Moves which copied the data
+	std::uint64_t bytes_moved_left = 0;                             //Copied by GapMoveLeft
+	std::uint64_t bytes_moved_right = 0;                            //Copied by GapMoveRight
+	std::uint64_t shifts = 0;                                       //Edits of the adaptive policy which kept the gap
+	std::uint64_t bytes_shifted = 0;                                //Data shifted by them
+	std::uint64_t expansions = 0;                                   //Reallocations which grew the storage
+	std::uint64_t expansion_bytes = 0;                              //Sizes of the grown storages
+	std::uint64_t peak_storage_bytes = 0;                           //The biggest StorageSize
+	bool cache_miss_sampling = false;
+	std::uint64_t sampled_moves = 0;                                //Gap moves measured by the cache miss counter
+	std::uint64_t cache_misses = 0;                                 //Cache misses of the sampled moves
+	std::array<std::uint64_t, distance_buckets> move_distances{};
+};
+
+std::string StatsToJson(const gap_stats&, bool enabled);         //One JSON object, empty buckets are omitted
+
+//Hardware counter of the cache misses of the calling thread, perf_event_open on Linux.
+//It can't be opened on the other systems and when the kernel doesn't allow the counter.
+class cache_miss_counter {
+  public:
+	cache_miss_counter() = default;
+	cache_miss_counter(const cache_miss_counter&) = delete;
+	cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+   ~cache_miss_counter() { Close(); }
+
+	bool Open() noexcept;                                           //Returns false if the counter isn't available
+	bool IsOpen() const noexcept { return fd != -1; }
+	std::uint64_t Read() const noexcept;                            //Misses since the counter is opened
+	void Close() noexcept;
+
+  private:
+	int fd = -1;
+};
+
+//Recorder of the buffer. The buffer calls it on every gap move and reallocation,
+//the copies and the moves of the buffer start with the zero counters.
+template <bool Enabled> class stats_recorder;
+
+template <>
+class stats_recorder<false> {
+  public:
+	gap_stats Get(std::size_t) const noexcept { return {}; }
+	void Reset() noexcept { }
+	bool SampleCacheMisses(bool) noexcept { return false; }
+	void MoveCall() noexcept { }
+	std::uint64_t StartMove() const noexcept { return 0; }
+	void FinishMove(std::uint64_t) noexcept { }
+	void MovedLeft(std::size_t) noexcept { }
+	void MovedRight(std::size_t) noexcept { }
+	void Shifted(std::size_t) noexcept { }
+	void Expansion(std::size_t) noexcept { }
+	void Storage(std::size_t) noexcept { }
+};
+
+template <>
+class stats_recorder<true> {
+  public:
+	//Recieve the current storage size, it can be the peak
+	gap_stats Get(std::size_t storage_bytes) const noexcept {
+		gap_stats result = counters;
+		result.peak_storage_bytes = std::max<std::uint64_t>(result.peak_storage_bytes, storage_bytes);
+		result.cache_miss_sampling = counter.IsOpen();
+		return result;
+	}
+	void Reset() noexcept { counters = gap_stats(); }
+	bool SampleCacheMisses(bool enable) noexcept {
+		if (!enable) {
+			counter.Close();
+			return true;
+		}
+		return counter.IsOpen() || counter.Open();
+	}
+
+	void MoveCall() noexcept { ++counters.move_calls; }
+	std::uint64_t StartMove() const noexcept { return counter.IsOpen() ? counter.Read() : 0; }
+	void FinishMove(std::uint64_t start) noexcept {
+		if (!counter.IsOpen())
+			return;
+		const std::uint64_t end = counter.Read();
+		++counters.sampled_moves;
+		counters.cache_misses += end > start ? end - start : 0;
+	}
+	void MovedLeft(std::size_t bytes) noexcept { counters.bytes_moved_left += bytes; Moved(bytes); }
+	void MovedRight(std::size_t bytes) noexcept { counters.bytes_moved_right += bytes; Moved(bytes); }
+	void Shifted(std::size_t bytes) noexcept { ++counters.shifts; counters.bytes_shifted += bytes; }
+	void Expansion(std::size_t bytes) noexcept { ++counters.expansions; counters.expansion_bytes += bytes; Storage(bytes); }
+	void Storage(std::size_t bytes) noexcept { counters.peak_storage_bytes = std::max<std::uint64_t>(counters.peak_storage_bytes, bytes); }
+
+  private:
+	void Moved(std::size_t bytes) noexcept {
+		++counters.gap_moves;
+		const std::size_t bucket = static_cast<std::size_t>(std::bit_width(bytes)) - 1;
+		++counters.move_distances[std::min(bucket, gap_stats::distance_buckets - 1)];
+	}
+
+	gap_stats counters;
+	cache_miss_counter counter;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef UNDOJOURNAL_H
+#define UNDOJOURNAL_H
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <span>
+#include <cstddef>
+
+//Journal of the edits for undo and redo. Every edit is recorded as its offset, the erased
+//and the inserted elements, so the memory is proportional to the edits, not to the data.
+//Single element inserts and removals which continue each other are coalesced into one record.
+//The oldest records are dropped when the memory is over the budget.
+template <class T>
+class undo_journal {
+  public:
+	using size_type = std::size_t;
+	using segment = std::span<const T>;
+
+	//Replacement of the erased elements at offset by the inserted ones
+	struct record {
+		size_type offset;
+		std::vector<T> erased;
+		std::vector<T> inserted;
+		bool joined;                                                //Undone and redone together with the previous record
+		bool typing;                                                //Single element edit which can be continued
+		bool reversed = false;                                      //Erased elements are kept from the last one while Backspace continues the record
+	};
+
+	//Edits which are done while the guard lives aren't recorded
+	class replay_guard {
+	  public:
+		explicit replay_guard(undo_journal& j) noexcept : journal(j) { journal.recording = false; }
+		replay_guard(const replay_guard&) = delete;
+		replay_guard& operator=(const replay_guard&) = delete;
+	   ~replay_guard() { journal.recording = true; }
+
+	  private:
+		undo_journal& journal;
+	};
+
+	static constexpr size_type default_budget = 64 << 20;
+
+	void Enable(const size_type& new_budget) { enabled = true; SetBudget(new_budget); }
+	void Disable() noexcept { Clear(); enabled = false; }
+	bool IsEnabled() const noexcept { return enabled; }
+	bool IsRecording() const noexcept { return enabled && recording; }
+	void SetBudget(const size_type& new_budget) { budget = new_budget; Trim(); }
+	size_type Budget() const noexcept { return budget; }
+	size_type Memory() const noexcept { return memory; }            //Bytes taken by the records
+	void Clear() noexcept { records.clear(); current = 0; memory = 0; sealed = false; }
+
+	void RecordInsert(const size_type&, segment);
+	void RecordErase(const size_type&, segment, segment);           //The erased elements may be split by the gap
+	void RecordEdit(const size_type&, segment, segment, segment, bool joined); //Replacement, the erased elements are split by the gap
+
+	//Undo and redo give the records to apply in their order. Undo gives the records
+	//of the group from the last one, redo from the first one.
+	bool CanUndo() const noexcept { return current > 0; }
+	bool CanRedo() const noexcept { return current < records.size(); }
+	const record& NextUndo() noexcept { sealed = true; return Normalize(records[--current]); }
+	const record& NextRedo() noexcept { sealed = true; return records[current++]; }
+	bool RedoJoined() const noexcept { return current < records.size() && records[current].joined; } //Next redo record belongs to the same group
+
+  private:
+	void Push(record&&);
+	void Trim();
+	static record& Normalize(record&) noexcept;                     //Erased elements are put in their order
+	static std::vector<T> Concat(segment, segment);
+	static size_type Footprint(const record& r) noexcept { return sizeof(record) + (r.erased.capacity() + r.inserted.capacity()) * sizeof(T); }
+
+  private:
+	std::deque<record> records;
+	size_type current = 0;                                          //Count of the applied records, the next ones are redone
+	size_type budget = default_budget;
+	size_type memory = 0;
+	bool enabled = false;
+	bool recording = true;
+	bool sealed = false;                                            //The last record can't be continued after undo and redo
+};
+
+//Recieve the offset and the inserted elements. The single element typed right after
+//the previous typed elements is appended to their record.
+template <class T>
+void undo_journal<T>::RecordInsert(const size_type& offset, segment items) {
+	if (current > 0 && items.size() == 1 && !sealed) {
+		record& last = records[current - 1];
+		if (current == records.size() && last.typing && last.erased.empty() && last.offset + last.inserted.size() == offset) {
+			memory -= Footprint(last);
+			last.inserted.push_back(items[0]);
+			memory += Footprint(last);
+			Trim();
+			return;
+		}
+	}
+	Push({ offset, {}, std::vector<T>(std::begin(items), std::end(items)), false, items.size() == 1 });
+}
+
+//Recieve the offset and the erased elements. Single element removals by Delete continue
+//the record at the same offset, by Backspace the record at the next offset. Backspace
+//appends to the reversed record, it's put in order once when it's sealed.
+template <class T>
+void undo_journal<T>::RecordErase(const size_type& offset, segment first, segment second) {
+	const size_type count = first.size() + second.size();
+	if (current > 0 && count == 1 && !sealed) {
+		record& last = records[current - 1];
+		const T& item = first.empty() ? second[0] : first[0];
+		if (current == records.size() && last.typing && last.inserted.empty() && (last.offset == offset || last.offset == offset + 1)) {
+			memory -= Footprint(last);
+			if (last.offset == offset)
+				Normalize(last).erased.push_back(item);
+			else {
+				if (!last.reversed) {
+					std::reverse(std::begin(last.erased), std::end(last.erased));
+					last.reversed = true;
+				}
+				last.erased.push_back(item);
+				last.offset = offset;
+			}
+			memory += Footprint(last);
+			Trim();
+			return;
+		}
+	}
+	Push({ offset, Concat(first, second), {}, false, count == 1 });
+}
+
+template <class T>
+void undo_journal<T>::RecordEdit(const size_type& offset, segment first, segment second, segment items, bool joined) {
+	Push({ offset, Concat(first, second), std::vector<T>(std::begin(items), std::end(items)), joined, false });
+}
+
+template <class T>
+std::vector<T> undo_journal<T>::Concat(segment first, segment second) {
+	std::vector<T> items;
+	items.reserve(first.size() + second.size());
+	items.insert(std::end(items), std::begin(first), std::end(first));
+	items.insert(std::end(items), std::begin(second), std::end(second));
+	return items;
+}
+
+//The new record replaces the records which could be redone
+template <class T>
+void undo_journal<T>::Push(record&& change) {
+	//The start of the group is already dropped by the budget
+	if (change.joined && current == 0)
+		return;
+
+	while (records.size() > current) {
+		memory -= Footprint(records.back());
+		records.pop_back();
+	}
+	if (current > 0)
+		Normalize(records[current - 1]);
+	memory += Footprint(change);
+	records.push_back(std::move(change));
+	++current;
+	sealed = false;
+	Trim();
+}
+
+template <class T>
+auto undo_journal<T>::Normalize(record& change) noexcept -> record& {
+	if (change.reversed) {
+		std::reverse(std::begin(change.erased), std::end(change.erased));
+		change.reversed = false;
+	}
+	return change;
+}
+
+//The oldest groups are dropped until the memory fits the budget. The records to redo
+//can't be dropped from their start, they are dropped all at once.
+template <class T>
+void undo_journal<T>::Trim() {
+	while (memory > budget && !records.empty()) {
+		if (current == 0) {
+			Clear();
+			return;
+		}
+		do {
+			memory -= Footprint(records.front());
+			records.pop_front();
+			if (current > 0)
+				--current;
+		} while (!records.empty() && records.front().joined);
+	}
+}
+
+#endif
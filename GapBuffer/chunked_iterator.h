@@ -0,0 +1,122 @@
+#ifndef CHUNKEDGAPBUFFER_ITERATOR
+#define CHUNKEDGAPBUFFER_ITERATOR
+
+#include "ChunkedGapBuffer.h"
+#include "Exception.h"
+#include <iterator>
+#include <type_traits>
+
+//Iterator goes through the segments of the leaf and jumps to the next leaf at its end.
+//It keeps the segment bounds of the current leaf, so an increment is a pointer increment
+//plus two branches. The iterator at the end of the non-last leaf is moved to the next leaf.
+//Mutable iterators copy the shared leaves which they come to.
+template <class T, class Alloc>
+template <bool IsConst>
+class basic_chunked_gap_buffer<T, Alloc>::basic_iterator {
+	using owner_type = std::conditional_t<IsConst, const basic_chunked_gap_buffer, basic_chunked_gap_buffer>;
+	using storage_iter = std::conditional_t<IsConst, const T*, T*>;
+
+  public:
+	//Synonymous
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using pointer = storage_iter;
+	using reference = std::conditional_t<IsConst, const T&, T&>;
+
+	//Constructors
+	basic_iterator() = default;
+	basic_iterator(owner_type* o, const size_type& leaf, const size_type& local) : owner(o) { Load(leaf, local); }
+	template <bool Const = IsConst, typename = std::enable_if_t<Const>>
+	basic_iterator(const basic_iterator<false>& rhs) : owner(rhs.owner), leaf(rhs.leaf), ptr(rhs.ptr), first_beg(rhs.first_beg), first_end(rhs.first_end), second_beg(rhs.second_beg), second_end(rhs.second_end) { }
+
+	//Operators
+	basic_iterator& operator++() {
+#if GAPBUFFER_CHECKED_ITERATORS
+		if (!IsIterDereferenceable(ptr, second_end))
+			ThrowOutOfRange();
+#endif
+		if (++ptr == first_end)
+			ptr = second_beg;
+		if (ptr == second_end && leaf + 1 < owner->leaves.size())
+			Load(leaf + 1, 0);
+		return *this;
+	}
+	basic_iterator operator++(int) { auto copy = *this; ++*this; return copy; }
+	basic_iterator& operator--() {
+#if GAPBUFFER_CHECKED_ITERATORS
+		if (leaf == 0 && IsIterOutOfRange(Local(), -1, owner->leaves[0]->Size()))
+			ThrowOutOfRange();
+#endif
+		if (Local() == 0)
+			Load(leaf - 1, owner->leaves[leaf - 1]->Size());
+		if (ptr == second_beg)
+			ptr = first_end;
+		--ptr;
+		return *this;
+	}
+	basic_iterator operator--(int) { auto copy = *this; --*this; return copy; }
+	difference_type operator-(const basic_iterator& rhs) const { return static_cast<difference_type>(Index()) - static_cast<difference_type>(rhs.Index()); }
+	basic_iterator operator+(difference_type shift) const { auto copy = *this; copy.Shift(shift); return copy; }
+	basic_iterator operator-(difference_type shift) const { auto copy = *this; copy.Shift(-shift); return copy; }
+	basic_iterator& operator+=(difference_type shift) { Shift(shift); return *this; }
+	basic_iterator& operator-=(difference_type shift) { Shift(-shift); return *this; }
+	reference operator[](difference_type shift) const { return *(*this + shift); }
+	reference operator*() const {
+#if GAPBUFFER_CHECKED_ITERATORS
+		if (!IsIterDereferenceable(ptr, second_end))
+			ThrowOutOfRange();
+#endif
+		return *ptr;
+	}
+	pointer operator->() const { return &**this; }
+
+	//Operators of comparison, leaves go in the order of the data. The end of one leaf storage
+	//may be the start of another one, so the leaves are compared too.
+	bool operator==(const basic_iterator& rhs) const { return ptr == rhs.ptr && leaf == rhs.leaf; }
+	bool operator!=(const basic_iterator& rhs) const { return !(*this == rhs); }
+	bool operator<(const basic_iterator& rhs) const { return leaf < rhs.leaf || (leaf == rhs.leaf && ptr < rhs.ptr); }
+	bool operator<=(const basic_iterator& rhs) const { return !(rhs < *this); }
+	bool operator>(const basic_iterator& rhs) const { return rhs < *this; }
+	bool operator>=(const basic_iterator& rhs) const { return !(*this < rhs); }
+
+  private:
+	//Recieve the leaf and the index inside it, the segment bounds are taken from the leaf
+	void Load(const size_type& index, const size_type& local) {
+		if constexpr (!IsConst)
+			owner->Unique(index);
+		const auto [before, after] = owner->leaves[index]->Segments();
+		leaf = index;
+		first_beg = const_cast<storage_iter>(before.data());
+		first_end = first_beg + before.size();
+		second_beg = const_cast<storage_iter>(after.data());
+		second_end = second_beg + after.size();
+		ptr = local < before.size() ? first_beg + local : second_beg + (local - before.size());
+	}
+	size_type Local() const { return ptr < first_end && ptr >= first_beg ? ptr - first_beg : (first_end - first_beg) + (ptr - second_beg); } //Index inside the leaf
+	size_type Index() const { return owner->sizes.PrefixSum(leaf) + Local(); } //Logical position of the iterator
+	void Shift(difference_type shift) {
+		const auto index = static_cast<difference_type>(Index());
+#if GAPBUFFER_CHECKED_ITERATORS
+		if (IsIterOutOfRange(index, shift, owner->Size()))
+			ThrowOutOfRange();
+#endif
+		const auto [to_leaf, local] = owner->Locate(static_cast<size_type>(index + shift));
+		Load(to_leaf, local);
+	}
+
+  private:
+	owner_type* owner = nullptr;
+	size_type leaf = 0;
+	storage_iter ptr = nullptr;                  //Real position in the leaf storage
+	storage_iter first_beg = nullptr;            //Data before the gap of the leaf
+	storage_iter first_end = nullptr;
+	storage_iter second_beg = nullptr;           //Data after the gap of the leaf
+	storage_iter second_end = nullptr;
+
+  private:
+	friend class basic_chunked_gap_buffer;
+	friend class basic_iterator<!IsConst>;
+};
+
+#endif
@@ -4,23 +4,25 @@
 #include "GapBuffer.h"
 #include "Exception.h"
 #include <vector>
+#include <iterator>
 
 //Iterator allows to navigate through the data skipping a gap buffer
-class GapBuffer::const_iterator {
+template <class T, class Alloc>
+class basic_gap_buffer<T, Alloc>::const_iterator {
   public:
 	//Synonymous
-	using vec_char_citer = std::vector<char>::const_iterator;
+	using storage_iter = const T*;
 	using iterator_category = std::random_access_iterator_tag;
-	using value_type = const char;
+	using value_type = T;
 	using difference_type = std::ptrdiff_t;
-	using pointer = const char*;
-	using reference = char&;
+	using pointer = const T*;
+	using reference = const T&;
 
 	//Constructors
-	const_iterator() : gap_start(nullptr), gap_end(nullptr) { } 
-	const_iterator(vec_char_citer gap_s, vec_char_citer, vec_char_citer, size_type*, size_type*);
+	const_iterator() : data_beg(nullptr), data_end(nullptr), ptr(nullptr), gap_start(nullptr), gap_end(nullptr) { }
+	const_iterator(storage_iter, storage_iter, storage_iter, size_type*, size_type*);
 	const_iterator(const const_iterator& rhs) : data_beg(rhs.data_beg), data_end(rhs.data_end), ptr(rhs.ptr), gap_start(rhs.gap_start), gap_end(rhs.gap_end) { }
-   ~const_iterator() = default;  //We don't delete pointers because GapBuffer object owns data they point to.
+   ~const_iterator() = default;  //We don't delete pointers because GapBuffer object owns them.
 
 	//Operators
 	const_iterator& operator++();
@@ -30,10 +32,10 @@ class GapBuffer::const_iterator {
 	difference_type operator-(const const_iterator&) const;
 	const_iterator operator+(size_type) const;
 	const_iterator operator-(size_type) const;
-	const const_iterator& operator-=(size_type);
-	const const_iterator& operator+=(size_type);
-	const_reference operator[](size_type) const;
-	const const_iterator& operator=(const const_iterator&);
+	const_iterator& operator-=(size_type);
+	const_iterator& operator+=(size_type);
+	reference operator[](size_type) const;
+	const_iterator& operator=(const const_iterator&);
 	reference operator*() const;
 	pointer operator->() const;
 
@@ -45,24 +47,183 @@ class GapBuffer::const_iterator {
 	bool operator>(const const_iterator& rhs) const { return ptr > rhs.ptr; }
 	bool operator>=(const const_iterator& rhs) const { return ptr >= rhs.ptr; }
 
-	template<typename GAPIt, typename It>
-	friend bool IsIterOutOfRange<GAPIt, It>(GAPIt, It, const char&, const int&);
-
   private:
-	bool BelongsToBuffer(vec_char_citer) const;
-	bool WillSkipGap(vec_char_citer, const char&, const int&) const;
+	bool BelongsToBuffer(storage_iter) const;
+	difference_type Index() const;                //Logical position of the iterator, the gap isn't counted
+	difference_type Size() const;                 //Logical size of the container
+	void Shift(difference_type);                  //Move the iterator by the logical shift skipping the gap
 
   private:
-	vec_char_citer data_beg;         //Iterator points to the start of common storage
-	vec_char_citer data_end;         //To the end
-	vec_char_citer ptr;              //To the real position of this object-iterator in the storage
-	size_type* gap_start;            //Pointer to the actual number of start of gap position of the object.
-    size_type* gap_end;              //End gap position.
+	storage_iter data_beg;                       //Iterator points to the start of common storage
+	storage_iter data_end;                       //To the end
+	storage_iter ptr;                            //To the real position of this object-iterator in the storage
+	size_type* gap_start;                        //Pointer to the actual number of start of gap position of the object.
+	size_type* gap_end;                          //End gap position.
 	//I use a model with 4 data types storing information about the
 	//GapBuffer object which this iterator points to, instead, you can
-	//use only a reference to the GapBuffer object...
+	//use only a reference to the GapBuffer object.
   private:
-	friend class GapBuffer;
+	friend class basic_gap_buffer;
 };
 
-#endif
\ No newline at end of file
+//const_iterator constructor, if the first element is in a gap buffer the iterator
+//is moved to the first element after the gap. Also, initializing reference in the intializer list is very important.
+template <class T, class Alloc>
+basic_gap_buffer<T, Alloc>::const_iterator::const_iterator(storage_iter beg, storage_iter end, storage_iter p, size_type* gap_s, size_type* gap_e) : data_beg(beg), data_end(end), ptr(p), gap_start(gap_s), gap_end(gap_e) {
+	if (BelongsToBuffer(p))
+		ptr = data_beg + *gap_end;
+}
+
+//Hot operators are defined inline, so with unchecked iterators an increment is
+//a pointer increment plus one gap-skip branch.
+
+//Prefix increment
+template <class T, class Alloc>
+inline auto basic_gap_buffer<T, Alloc>::const_iterator::operator++() -> const_iterator& {
+	if (IsIterOutOfRange(Index(), 1, Size()))
+		ThrowOutOfRange();
+
+	if (++ptr == data_beg + *gap_start)
+		ptr = data_beg + *gap_end;
+
+	return *this;
+}
+
+//Postfix increment
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator++(int) -> const_iterator {
+	const_iterator ret(*this);
+	++*this;
+	return ret;
+}
+
+//Prefix decrement
+template <class T, class Alloc>
+inline auto basic_gap_buffer<T, Alloc>::const_iterator::operator--() -> const_iterator& {
+	if (IsIterOutOfRange(Index(), -1, Size()))
+		ThrowOutOfRange();
+
+	if (ptr == data_beg + *gap_end)
+		ptr = data_beg + *gap_start;
+	--ptr;
+
+	return *this;
+}
+
+//Postfix decrement
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator--(int) -> const_iterator {
+	const_iterator ret(*this);
+	--(*this);
+	return ret;
+}
+
+//Distance between iterators including correct negative distance
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator-(const const_iterator& rhs) const -> difference_type {
+	return Index() - rhs.Index();
+}
+
+//Positive shift iterator
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator+(size_type inc) const -> const_iterator {
+	const_iterator ret_iter(*this);
+	ret_iter.Shift(static_cast<difference_type>(inc));
+	return ret_iter;
+}
+
+//Negative shift iterator
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator-(size_type dec) const -> const_iterator {
+	const_iterator ret_iter(*this);
+	ret_iter.Shift(-static_cast<difference_type>(dec));
+	return ret_iter;
+}
+
+//Other operators
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator-=(size_type dec) -> const_iterator& {
+	Shift(-static_cast<difference_type>(dec));
+	return *this;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator+=(size_type inc) -> const_iterator& {
+	Shift(static_cast<difference_type>(inc));
+	return *this;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator[](size_type index) const -> reference {
+	return *(*this + index);
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator=(const const_iterator& rhs) -> const_iterator& {
+	data_beg = rhs.data_beg;
+	data_end = rhs.data_end;
+	ptr = rhs.ptr;
+	gap_start = rhs.gap_start;
+	gap_end = rhs.gap_end;
+
+	return *this;
+}
+
+template <class T, class Alloc>
+inline auto basic_gap_buffer<T, Alloc>::const_iterator::operator*() const -> reference {
+	if (!IsIterDereferenceable(ptr, data_end))
+		ThrowOutOfRange();
+
+	return *ptr;
+}
+
+template <class T, class Alloc>
+auto basic_gap_buffer<T, Alloc>::const_iterator::operator->() const -> pointer {
+	return &(**this);
+}
+
+//Recieves iterator and check if the iterator belongs to GapBuffer
+template <class T, class Alloc>
+bool basic_gap_buffer<T, Alloc>::const_iterator::BelongsToBuffer(storage_iter p) const {
+	auto gap_start_it = data_beg + (*gap_start);
+	auto gap_end_it = data_beg + (*gap_end);
+	if (p >= gap_start_it && p < gap_end_it)
+		return true;
+
+	return false;
+}
+
+//The position in the storage minus the gap if the iterator is after it
+template <class T, class Alloc>
+inline auto basic_gap_buffer<T, Alloc>::const_iterator::Index() const -> difference_type {
+	difference_type index = ptr - data_beg;
+	if (index >= static_cast<difference_type>(*gap_end))
+		index -= *gap_end - *gap_start;
+
+	return index;
+}
+
+template <class T, class Alloc>
+inline auto basic_gap_buffer<T, Alloc>::const_iterator::Size() const -> difference_type {
+	return (data_end - data_beg) - static_cast<difference_type>(*gap_end - *gap_start);
+}
+
+//Recieves the logical shift. The new logical index is translated back to the storage
+//position, the only branch is the one which skips the gap.
+template <class T, class Alloc>
+void basic_gap_buffer<T, Alloc>::const_iterator::Shift(difference_type shift) {
+	const auto index = Index();
+	if (IsIterOutOfRange(index, shift, Size()))
+		ThrowOutOfRange();
+
+	const auto new_index = index + shift;
+	if (new_index < static_cast<difference_type>(*gap_start))
+		ptr = data_beg + new_index;
+	else
+		ptr = data_beg + (new_index + (*gap_end - *gap_start));
+}
+
+//The char const_iterator is compiled once in const_iterator.cpp
+extern template class basic_gap_buffer<char>::const_iterator;
+
+#endif